@@ -4,10 +4,37 @@
  *
  * Based on Analogue's documentation:
  * Each byte of the file is bit-reversed (bits[7:0] to bits[0:7])
+ *
+ * Usage:
+ *   reverse_bits [-c] <input.rbf> <output.rbf_r>
+ *   reverse_bits [-c] -b <input.rbf>...     (writes <input>.rbf_r next to each)
+ *
+ *   -c  print the CRC-32 of each output file
+ *   -b  batch mode
+ *
+ * The input is mmap'd (falling back to buffered reads) and reversed
+ * 8 bytes at a time with a 64-bit mask-and-shift network; output is
+ * written in large chunks.
  */
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#define CHUNK_SIZE (1 << 20)  /* 1MB output chunks */
+
+/* Reverse the bits inside each byte of a 64-bit word (byte order is kept) */
+static inline uint64_t reverse_bytes_bits64(uint64_t x) {
+    x = ((x >> 4) & 0x0F0F0F0F0F0F0F0FULL) | ((x & 0x0F0F0F0F0F0F0F0FULL) << 4);
+    x = ((x >> 2) & 0x3333333333333333ULL) | ((x & 0x3333333333333333ULL) << 2);
+    x = ((x >> 1) & 0x5555555555555555ULL) | ((x & 0x5555555555555555ULL) << 1);
+    return x;
+}
 
 unsigned char reverse_byte(unsigned char b) {
     b = (b & 0xF0) >> 4 | (b & 0x0F) << 4;
@@ -16,34 +43,198 @@ unsigned char reverse_byte(unsigned char b) {
     return b;
 }
 
-int main(int argc, char *argv[]) {
-    if (argc != 3) {
-        fprintf(stderr, "Usage: %s <input.rbf> <output.rbf_r>\n", argv[0]);
+static void reverse_buffer(unsigned char *dst, const unsigned char *src, size_t len) {
+    size_t i = 0;
+    for (; i + 8 <= len; i += 8) {
+        uint64_t w;
+        memcpy(&w, src + i, 8);
+        w = reverse_bytes_bits64(w);
+        memcpy(dst + i, &w, 8);
+    }
+    for (; i < len; i++) {
+        dst[i] = reverse_byte(src[i]);
+    }
+}
+
+/* CRC-32 (IEEE 802.3, same as zlib), slicing-by-4 */
+static uint32_t crc_table[4][256];
+
+static void crc32_init(void) {
+    for (uint32_t n = 0; n < 256; n++) {
+        uint32_t c = n;
+        for (int k = 0; k < 8; k++) {
+            c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+        }
+        crc_table[0][n] = c;
+    }
+    for (uint32_t n = 0; n < 256; n++) {
+        uint32_t c = crc_table[0][n];
+        for (int t = 1; t < 4; t++) {
+            c = crc_table[0][c & 0xFF] ^ (c >> 8);
+            crc_table[t][n] = c;
+        }
+    }
+}
+
+static uint32_t crc32_update(uint32_t crc, const unsigned char *p, size_t len) {
+    crc = ~crc;
+    while (len >= 4) {
+        crc ^= (uint32_t)p[0] | (uint32_t)p[1] << 8 | (uint32_t)p[2] << 16 | (uint32_t)p[3] << 24;
+        crc = crc_table[3][crc & 0xFF] ^ crc_table[2][(crc >> 8) & 0xFF] ^
+              crc_table[1][(crc >> 16) & 0xFF] ^ crc_table[0][crc >> 24];
+        p += 4;
+        len -= 4;
+    }
+    while (len--) {
+        crc = crc_table[0][(crc ^ *p++) & 0xFF] ^ (crc >> 8);
+    }
+    return ~crc;
+}
+
+static int write_all(int fd, const unsigned char *buf, size_t len) {
+    while (len > 0) {
+        ssize_t n = write(fd, buf, len);
+        if (n < 0) {
+            return -1;
+        }
+        buf += n;
+        len -= (size_t)n;
+    }
+    return 0;
+}
+
+static int convert_file(const char *in_path, const char *out_path, int print_crc) {
+    int in_fd = open(in_path, O_RDONLY);
+    if (in_fd < 0) {
+        fprintf(stderr, "Error: Cannot open input file '%s'\n", in_path);
         return 1;
     }
 
-    FILE *input = fopen(argv[1], "rb");
-    if (!input) {
-        fprintf(stderr, "Error: Cannot open input file '%s'\n", argv[1]);
+    int out_fd = open(out_path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (out_fd < 0) {
+        fprintf(stderr, "Error: Cannot create output file '%s'\n", out_path);
+        close(in_fd);
         return 1;
     }
 
-    FILE *output = fopen(argv[2], "wb");
-    if (!output) {
-        fprintf(stderr, "Error: Cannot create output file '%s'\n", argv[2]);
-        fclose(input);
+    unsigned char *out_buf = malloc(CHUNK_SIZE);
+    if (!out_buf) {
+        fprintf(stderr, "Error: Out of memory\n");
+        close(in_fd);
+        close(out_fd);
         return 1;
     }
 
-    int byte;
-    while ((byte = fgetc(input)) != EOF) {
-        unsigned char reversed = reverse_byte((unsigned char)byte);
-        fputc(reversed, output);
+    struct stat st;
+    const unsigned char *map = MAP_FAILED;
+    size_t size = 0;
+    if (fstat(in_fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0) {
+        size = (size_t)st.st_size;
+        map = mmap(NULL, size, PROT_READ, MAP_PRIVATE, in_fd, 0);
+        if (map != MAP_FAILED) {
+            madvise((void *)map, size, MADV_SEQUENTIAL);
+        }
     }
 
-    fclose(input);
-    fclose(output);
+    int err = 0;
+    uint32_t crc = 0;
+    size_t total = 0;
 
-    printf("Successfully converted %s to %s\n", argv[1], argv[2]);
+    if (map != MAP_FAILED) {
+        for (size_t off = 0; off < size && !err; off += CHUNK_SIZE) {
+            size_t n = size - off < CHUNK_SIZE ? size - off : CHUNK_SIZE;
+            reverse_buffer(out_buf, map + off, n);
+            if (print_crc) crc = crc32_update(crc, out_buf, n);
+            err = write_all(out_fd, out_buf, n);
+            total += n;
+        }
+        munmap((void *)map, size);
+    } else {
+        /* Not mappable (pipe, empty file) - buffered reads, reversed in place */
+        ssize_t n;
+        while (!err && (n = read(in_fd, out_buf, CHUNK_SIZE)) > 0) {
+            reverse_buffer(out_buf, out_buf, (size_t)n);
+            if (print_crc) crc = crc32_update(crc, out_buf, (size_t)n);
+            err = write_all(out_fd, out_buf, (size_t)n);
+            total += (size_t)n;
+        }
+        if (n < 0) err = 1;
+    }
+
+    free(out_buf);
+    close(in_fd);
+    if (close(out_fd) != 0) err = 1;
+
+    if (err) {
+        fprintf(stderr, "Error: I/O failure converting '%s'\n", in_path);
+        return 1;
+    }
+
+    printf("Successfully converted %s to %s (%zu bytes)\n", in_path, out_path, total);
+    if (print_crc) {
+        printf("CRC32 %08X  %s\n", crc, out_path);
+    }
     return 0;
 }
+
+/* foo.rbf -> foo.rbf_r, anything else -> <name>.rbf_r */
+static char *batch_output_name(const char *in_path) {
+    size_t len = strlen(in_path);
+    char *out = malloc(len + 8);
+    if (!out) return NULL;
+    memcpy(out, in_path, len + 1);
+    if (len >= 4 && strcmp(in_path + len - 4, ".rbf") == 0) {
+        strcat(out, "_r");
+    } else {
+        strcat(out, ".rbf_r");
+    }
+    return out;
+}
+
+static void usage(const char *prog) {
+    fprintf(stderr, "Usage: %s [-c] <input.rbf> <output.rbf_r>\n", prog);
+    fprintf(stderr, "       %s [-c] -b <input.rbf>...\n", prog);
+    fprintf(stderr, "  -c  print CRC-32 of each output\n");
+    fprintf(stderr, "  -b  batch mode: write <input>.rbf_r next to each input\n");
+}
+
+int main(int argc, char *argv[]) {
+    int print_crc = 0;
+    int batch = 0;
+    int argi = 1;
+
+    for (; argi < argc && argv[argi][0] == '-' && argv[argi][1] != '\0'; argi++) {
+        if (strcmp(argv[argi], "-c") == 0) {
+            print_crc = 1;
+        } else if (strcmp(argv[argi], "-b") == 0) {
+            batch = 1;
+        } else {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+
+    int nfiles = argc - argi;
+    if ((!batch && nfiles != 2) || (batch && nfiles < 1)) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    if (print_crc) crc32_init();
+
+    if (!batch) {
+        return convert_file(argv[argi], argv[argi + 1], print_crc);
+    }
+
+    int failed = 0;
+    for (; argi < argc; argi++) {
+        char *out_path = batch_output_name(argv[argi]);
+        if (!out_path) {
+            fprintf(stderr, "Error: Out of memory\n");
+            return 1;
+        }
+        failed |= convert_file(argv[argi], out_path, print_crc);
+        free(out_path);
+    }
+    return failed;
+}
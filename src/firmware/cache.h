@@ -0,0 +1,53 @@
+/*
+ * D$ maintenance for buffers shared with DMA (accelerators, the bridge)
+ *
+ * The VexRiscv D$ is write-through: every store reaches the bus, so the
+ * CPU never has dirty lines. What can go stale is a line holding SDRAM
+ * contents that a DMA engine has since overwritten. The core has no
+ * per-line operation, only the data cache management instruction
+ * (0x0000500F), which invalidates all 128 lines in about as many cycles.
+ * A range is rounded up to that. For 4KB or more it is also the cheapest
+ * way to do it.
+ *
+ * dcache_flush_range() makes the CPU's stores to a range visible to DMA.
+ * Stores through the write-combining alias (0x90000000) wait in
+ * cpu_system's buffer, and all SDRAM writes are posted into io_sdram's
+ * queue. An uncached read drains the buffer and completes behind every
+ * write queued before it.
+ */
+
+#ifndef CACHE_H
+#define CACHE_H
+
+#include <stdint.h>
+
+#define SDRAM_CACHED_BASE   0x10000000u
+#define SDRAM_UNCACHED_BASE 0x90000000u   /* write-combining alias */
+#define SDRAM_ALIAS_MASK    0x03FFFFFFu   /* 64MB */
+
+/* Uncached pointer to the same SDRAM word */
+static inline volatile uint32_t *sdram_uncached(const volatile void *p) {
+    return (volatile uint32_t *)(SDRAM_UNCACHED_BASE |
+                                 ((uintptr_t)p & SDRAM_ALIAS_MASK & ~3u));
+}
+
+/* Drop cached copies of [addr, addr + len): call after a DMA write,
+ * before reading the results through the cached window */
+static inline void dcache_inv_range(const volatile void *addr, uint32_t len) {
+    (void)addr;
+    (void)len;
+    __asm__ volatile(".word 0x0000500F" ::: "memory");
+}
+
+/* Make the CPU's stores to [addr, addr + len) visible to DMA: call
+ * before starting an engine that reads the range */
+static inline void dcache_flush_range(const volatile void *addr, uint32_t len) {
+    if (len == 0) {
+        return;
+    }
+    const volatile uint8_t *last = (const volatile uint8_t *)addr + len - 1;
+    (void)*sdram_uncached(last);
+    __asm__ volatile("" ::: "memory");
+}
+
+#endif /* CACHE_H */
@@ -0,0 +1,62 @@
+/*
+ * RISC-V counter CSRs for profiling
+ *
+ * cycle and instret are read with one csrr each, without a bus access,
+ * so timing a region no longer perturbs the D$ or the interconnect the
+ * way a SYS_CYCLE_LO load does. cycle counts clk_sys like SYS_CYCLE.
+ *
+ * mhpmcounter3-6 count the hardware event picked by mhpmevent3-6. The
+ * events come from cpu_system (HPM_* there); 0 stops a counter. The
+ * counters are not reset: read them before and after, as with cycle.
+ */
+
+#ifndef CSR_H
+#define CSR_H
+
+#include <stdint.h>
+
+/* mhpmevent values */
+#define HPM_NONE              0
+#define HPM_ICACHE_REFILL     1   /* I$ line refills */
+#define HPM_DCACHE_REFILL     2   /* D$ line refills */
+#define HPM_DBUS_WRITE        3   /* stores reaching the bus */
+#define HPM_IBUS_WAIT_RAM     4   /* cycles an ibus access to a target is outstanding */
+#define HPM_IBUS_WAIT_SDRAM   5
+#define HPM_IBUS_WAIT_PSRAM   6
+#define HPM_DBUS_WAIT_RAM     7   /* the same for dbus */
+#define HPM_DBUS_WAIT_SDRAM   8   /* including the write-combining alias */
+#define HPM_DBUS_WAIT_PSRAM   9
+#define HPM_DBUS_WAIT_TERM    10
+#define HPM_DBUS_WAIT_SYSREG  11
+#define HPM_WC_DRAIN          12  /* cycles the write-combining buffer drains */
+
+#define csr_read(csr) ({                                        \
+    uint32_t __v;                                               \
+    __asm__ volatile("csrr %0, " #csr : "=r"(__v));             \
+    __v; })
+
+#define csr_write(csr, val)                                     \
+    __asm__ volatile("csrw " #csr ", %0" :: "r"((uint32_t)(val)))
+
+static inline uint32_t rdcycle(void) {
+    return csr_read(cycle);
+}
+
+static inline uint32_t rdinstret(void) {
+    return csr_read(instret);
+}
+
+static inline uint64_t rdcycle64(void) {
+    uint32_t hi, lo;
+    do {
+        hi = csr_read(cycleh);
+        lo = csr_read(cycle);
+    } while (hi != csr_read(cycleh));
+    return ((uint64_t)hi << 32) | lo;
+}
+
+/* n is 3-6; a literal, since the CSR number is part of the instruction */
+#define hpm_select(n, event) csr_write(mhpmevent##n, event)
+#define hpm_read(n)          csr_read(mhpmcounter##n)
+
+#endif /* CSR_H */
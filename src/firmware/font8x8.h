@@ -7,9 +7,11 @@
 #define FONT8X8_H
 
 #include <stdint.h>
+#include "sections.h"
 
 /* Each character is 8 bytes, one byte per row, MSB is leftmost pixel */
-static const uint8_t font8x8[96][8] = {
+/* Lives in SDRAM - glyphs in use stay resident in the D$ */
+SDRAM_RODATA static const uint8_t font8x8[96][8] = {
     /* 32 ' ' */ {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00},
     /* 33 '!' */ {0x18, 0x18, 0x18, 0x18, 0x18, 0x00, 0x18, 0x00},
     /* 34 '"' */ {0x6C, 0x6C, 0x24, 0x00, 0x00, 0x00, 0x00, 0x00},
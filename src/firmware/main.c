@@ -5,6 +5,7 @@
 
 #include <stdint.h>
 #include "font8x8.h"
+#include "sections.h"
 
 /* Hardware registers */
 #define SYS_STATUS        (*(volatile uint32_t*)0x40000000)
@@ -13,10 +14,20 @@
 #define SYS_DISPLAY_MODE  (*(volatile uint32_t*)0x4000000C)
 #define SYS_FB_SWAP       (*(volatile uint32_t*)0x40000018)
 
-/* Framebuffer addresses in SDRAM */
-#define FRAMEBUFFER_0     ((volatile uint16_t*)0x10000000)
-#define FRAMEBUFFER_1     ((volatile uint16_t*)0x10100000)
-
+/* Framebuffer addresses in SDRAM, through the uncached write-combining
+ * alias (0x90000000): pixel stores bypass the D$ and reach SDRAM as row
+ * bursts. SYS_FB_SWAP drains the buffer before the swap. */
+#define FRAMEBUFFER_0     ((volatile uint16_t*)0x90000000)
+#define FRAMEBUFFER_1     ((volatile uint16_t*)0x90100000)
+
+/* Memory test regions - placed by tools/plan_memory.py when a plan exists */
+#if __has_include("model_map.h")
+#include "model_map.h"
+#define SDRAM_TEST_BASE   ((volatile uint32_t*)MAP_SDRAM_MEMTEST_ADDR)
+#define SDRAM_TEST_SIZE   MAP_SDRAM_MEMTEST_SIZE
+#define PSRAM_TEST_BASE   ((volatile uint32_t*)MAP_PSRAM_MEMTEST_ADDR)
+#define PSRAM_TEST_SIZE   MAP_PSRAM_MEMTEST_SIZE
+#else
 /* SDRAM test region (after framebuffers) */
 #define SDRAM_TEST_BASE   ((volatile uint32_t*)0x10200000)
 #define SDRAM_TEST_SIZE   (1024 * 1024)  /* 1MB test region */
@@ -24,6 +35,7 @@
 /* PSRAM test region */
 #define PSRAM_TEST_BASE   ((volatile uint32_t*)0x30000000)
 #define PSRAM_TEST_SIZE   (1024 * 1024)  /* 1MB test region (of 16MB available) */
+#endif
 
 /* Display constants */
 #define FB_WIDTH   320
@@ -64,7 +76,7 @@ static inline void put_pixel(int x, int y, uint16_t color) {
     }
 }
 
-static void fill_rect(int x, int y, int w, int h, uint16_t color) {
+HOT static void fill_rect(int x, int y, int w, int h, uint16_t color) {
     for (int j = 0; j < h; j++) {
         for (int i = 0; i < w; i++) {
             put_pixel(x + i, y + j, color);
@@ -83,7 +95,7 @@ static void draw_rect(int x, int y, int w, int h, uint16_t color) {
     }
 }
 
-static void draw_char(int x, int y, char c, uint16_t color) {
+HOT static void draw_char(int x, int y, char c, uint16_t color) {
     if (c < 32 || c > 127) c = '?';
     const uint8_t* glyph = font8x8[c - 32];
     for (int row = 0; row < 8; row++) {
@@ -311,7 +323,7 @@ static int test_psram_address(int offset, int count) {
     if (expr) { cpu_tests_passed++; } \
 } while(0)
 
-static void test_cpu_arithmetic(void) {
+COLD static void test_cpu_arithmetic(void) {
     volatile int a = 100, b = 25;
 
     TEST("ADD", a + b == 125);
@@ -322,7 +334,7 @@ static void test_cpu_arithmetic(void) {
     TEST("NEG", -a == -100);
 }
 
-static void test_cpu_logical(void) {
+COLD static void test_cpu_logical(void) {
     volatile uint32_t a = 0xFF00FF00, b = 0x0F0F0F0F;
 
     TEST("AND", (a & b) == 0x0F000F00);
@@ -331,7 +343,7 @@ static void test_cpu_logical(void) {
     TEST("NOT", (~a) == 0x00FF00FF);
 }
 
-static void test_cpu_shifts(void) {
+COLD static void test_cpu_shifts(void) {
     volatile uint32_t a = 0x80000001;
     volatile int32_t sa = -16;
 
@@ -340,7 +352,7 @@ static void test_cpu_shifts(void) {
     TEST("SRA", (sa >> 2) == -4);  /* Arithmetic shift */
 }
 
-static void test_cpu_compare(void) {
+COLD static void test_cpu_compare(void) {
     volatile int a = -5, b = 10;
     volatile uint32_t ua = 0xFFFFFFFF, ub = 1;
 
@@ -349,7 +361,7 @@ static void test_cpu_compare(void) {
     TEST("SLTU", (ub < ua) == 1);  /* Unsigned compare */
 }
 
-static void test_cpu_memory(void) {
+COLD static void test_cpu_memory(void) {
     volatile uint32_t val32 = 0xDEADBEEF;
     volatile uint16_t val16 = 0xCAFE;
     volatile uint8_t val8 = 0x42;
@@ -363,7 +375,7 @@ static void test_cpu_memory(void) {
     TEST("LB/SB", r8 == 0x42);
 }
 
-static void test_cpu_branch(void) {
+COLD static void test_cpu_branch(void) {
     volatile int x = 0;
     volatile int a = 5, b = 5, c = 10;
 
@@ -393,6 +405,16 @@ static void swap_buffers(void) {
     draw_buffer = (draw_buffer == FRAMEBUFFER_1) ? FRAMEBUFFER_0 : FRAMEBUFFER_1;
 }
 
+/* ============================================ */
+/* Profiling hook                               */
+/* ============================================ */
+
+/* Called once per frame. The pgo-gen build overrides this (pgo_dump.c)
+ * to dump its profile; keeping the call in every build keeps main()'s
+ * control flow identical between the instrumented and optimised builds. */
+__attribute__((weak)) void frame_hook(void) {
+}
+
 /* ============================================ */
 /* Main dashboard                               */
 /* ============================================ */
@@ -505,6 +527,17 @@ static void draw_dashboard(int sdram_progress, int psram_progress, uint32_t cycl
     }
 }
 
+#ifdef PERF_BENCH
+/* Benchmark entry points for perf.c (VARIANT=perf) */
+void perf_dashboard_frame(void) {
+    draw_dashboard(50, 50, 0);
+}
+
+int perf_memtest_block(void) {
+    return test_sdram_pattern(0xAAAAAAAA, 0, 1024);
+}
+#endif
+
 int main(void) {
     /* Switch to framebuffer mode */
     SYS_DISPLAY_MODE = 1;
@@ -538,6 +571,7 @@ int main(void) {
         /* Draw dashboard */
         draw_dashboard(sdram_progress, psram_progress, cycles);
         swap_buffers();
+        frame_hook();
 
         /* Run SDRAM tests if not complete */
         if (sdram_test_offset < sdram_total_words) {
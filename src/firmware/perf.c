@@ -0,0 +1,197 @@
+/*
+ * Cycle-count benchmarks for the perf firmware variant
+ * On the first frame (dashboard drawn, CPU tests run) times a fixed set
+ * of hot paths with the cycle CSR, records them with the SDRAM data
+ * beats io_sdram moved meanwhile in perf_results, then halts. The
+ * simulation harness prints the block and tools/perf_check.py compares
+ * it against perf_baseline.json (see "make perf"). Each entry also
+ * records the cycles instruction fetches waited on BRAM (mhpmcounter3).
+ *
+ * Each benchmark runs once to warm the caches, then once timed.
+ */
+
+#include <stdint.h>
+#include "sections.h"
+#include "csr.h"
+
+#define SYS_SDRAM_STAT_CTRL (*(volatile uint32_t*)0x4000001C)
+#define SYS_SDRAM_STAT(n) (((volatile uint32_t*)0x40000040)[n])
+
+#define SDRAM_STAT_SNAPSHOT    1
+#define SDRAM_STAT_CLEAR       2
+#define SDRAM_STAT_READ_BEATS  2   /* io_sdram STAT_* index */
+#define SDRAM_STAT_WRITE_BEATS 3
+
+#define PERF_MAGIC   0x46524550  /* "PERF" */
+#define PERF_MAX     8
+
+/* Matvec shape: one attention-sized row block, Q16.16 */
+#define MATVEC_ROWS  64
+#define MATVEC_COLS  256
+
+#define COPY_WORDS   4096        /* 16KB SDRAM -> SDRAM */
+#define TRIAD_WORDS  4096        /* STREAM triad: three 16KB SDRAM streams */
+#define MIX_WORDS    8192        /* 32KB in PSRAM, eight times the D$ */
+#define MIX_STEPS    512         /* PSRAM lines per psram_mix_pass call */
+
+/* Defined in main.c when built with PERF_BENCH */
+void perf_dashboard_frame(void);
+int perf_memtest_block(void);
+
+/* Read back by the runner through the ELF symbol; layout is fixed */
+struct perf_entry {
+    char name[12];
+    uint32_t cycles;
+    uint32_t sdram_beats;        /* 16-bit SDRAM reads + writes */
+    uint32_t ibus_wait_ram;      /* HPM_IBUS_WAIT_RAM cycles */
+};
+
+volatile struct {
+    uint32_t magic;
+    uint32_t count;
+    struct perf_entry entry[PERF_MAX];
+} perf_results;
+
+SDRAM_BSS static int32_t matvec_w[MATVEC_ROWS * MATVEC_COLS];
+static int32_t matvec_x[MATVEC_COLS];
+static int32_t matvec_y[MATVEC_ROWS];
+
+SDRAM_BSS static uint32_t copy_src[COPY_WORDS];
+SDRAM_BSS static uint32_t copy_dst[COPY_WORDS];
+
+SDRAM_BSS static int32_t triad_a[TRIAD_WORDS];
+SDRAM_BSS static int32_t triad_b[TRIAD_WORDS];
+SDRAM_BSS static int32_t triad_c[TRIAD_WORDS];
+
+SCRATCH_BSS static int32_t mix_src[MIX_WORDS];
+static volatile int32_t mix_sink;
+
+/* Q16.16 matrix-vector product, as the accelerator computes it */
+HOT static void matvec(int32_t *y, const int32_t *w, const int32_t *x, int rows, int cols) {
+    for (int r = 0; r < rows; r++) {
+        const int32_t *row = w + r * cols;
+        int64_t acc = 0;
+        for (int c = 0; c < cols; c++) {
+            acc += (int64_t)row[c] * x[c];
+        }
+        y[r] = (int32_t)(acc >> 16);
+    }
+}
+
+HOT static void copy_words(uint32_t *dst, const uint32_t *src, int count) {
+    for (int i = 0; i < count; i++) {
+        dst[i] = src[i];
+    }
+}
+
+HOT static void triad(int32_t *a, const int32_t *b, const int32_t *c, int32_t scalar, int count) {
+    for (int i = 0; i < count; i++) {
+        a[i] = b[i] + scalar * c[i];
+    }
+}
+
+/* One PSRAM line refill per step, with the step's instructions fetched
+ * from BRAM. A pass is straight-line code over twice the (direct-mapped,
+ * 4KB) I$, so every I$ line misses on every pass and the instruction
+ * refills from BRAM overlap the data refills from PSRAM. */
+#define MIX_STEP(n)    acc = acc * 31 + src[8 * (n)]; acc ^= acc >> 11;
+#define MIX_STEP4(n)   MIX_STEP(n) MIX_STEP((n) + 1) MIX_STEP((n) + 2) MIX_STEP((n) + 3)
+#define MIX_STEP16(n)  MIX_STEP4(n) MIX_STEP4((n) + 4) MIX_STEP4((n) + 8) MIX_STEP4((n) + 12)
+#define MIX_STEP64(n)  MIX_STEP16(n) MIX_STEP16((n) + 16) MIX_STEP16((n) + 32) MIX_STEP16((n) + 48)
+#define MIX_STEP256(n) MIX_STEP64(n) MIX_STEP64((n) + 64) MIX_STEP64((n) + 128) MIX_STEP64((n) + 192)
+
+HOT __attribute__((noinline)) static int32_t psram_mix_pass(const int32_t *src, int32_t acc) {
+    MIX_STEP256(0)
+    MIX_STEP256(256)
+    return acc;
+}
+
+HOT static int32_t psram_mix(const int32_t *src, int count) {
+    int32_t acc = 0;
+    for (int i = 0; i < count; i += 8 * MIX_STEPS) {
+        acc = psram_mix_pass(src + i, acc);
+    }
+    return acc;
+}
+
+static void bench_dashboard(void) {
+    perf_dashboard_frame();
+}
+
+static void bench_memtest(void) {
+    perf_memtest_block();
+}
+
+static void bench_matvec(void) {
+    matvec(matvec_y, matvec_w, matvec_x, MATVEC_ROWS, MATVEC_COLS);
+}
+
+static void bench_memcpy(void) {
+    copy_words(copy_dst, copy_src, COPY_WORDS);
+}
+
+static void bench_triad(void) {
+    triad(triad_a, triad_b, triad_c, 3, TRIAD_WORDS);
+}
+
+static void bench_psram_mix(void) {
+    mix_sink = psram_mix(mix_src, MIX_WORDS);
+}
+
+static void perf_record(const char *name, void (*bench)(void)) {
+    uint32_t n = perf_results.count;
+    if (n >= PERF_MAX) {
+        return;
+    }
+
+    bench();
+    SYS_SDRAM_STAT_CTRL = SDRAM_STAT_CLEAR;
+    uint32_t ibus_wait = hpm_read(3);
+    uint32_t start = rdcycle();
+    bench();
+    uint32_t cycles = rdcycle() - start;
+    ibus_wait = hpm_read(3) - ibus_wait;
+    SYS_SDRAM_STAT_CTRL = SDRAM_STAT_SNAPSHOT;
+
+    int i = 0;
+    for (; name[i] && i < (int)sizeof(perf_results.entry[n].name) - 1; i++) {
+        perf_results.entry[n].name[i] = name[i];
+    }
+    for (; i < (int)sizeof(perf_results.entry[n].name); i++) {
+        perf_results.entry[n].name[i] = 0;
+    }
+    perf_results.entry[n].cycles = cycles;
+    perf_results.entry[n].sdram_beats = SYS_SDRAM_STAT(SDRAM_STAT_READ_BEATS) +
+                                        SYS_SDRAM_STAT(SDRAM_STAT_WRITE_BEATS);
+    perf_results.entry[n].ibus_wait_ram = ibus_wait;
+    perf_results.count = n + 1;
+}
+
+void frame_hook(void) {
+    for (int i = 0; i < MATVEC_ROWS * MATVEC_COLS; i++) {
+        matvec_w[i] = (i * 2654435761u) >> 14;
+    }
+    for (int i = 0; i < MATVEC_COLS; i++) {
+        matvec_x[i] = (i - MATVEC_COLS / 2) << 10;
+    }
+    for (int i = 0; i < COPY_WORDS; i++) {
+        copy_src[i] = i;
+    }
+    for (int i = 0; i < TRIAD_WORDS; i++) {
+        triad_b[i] = i;
+        triad_c[i] = TRIAD_WORDS - i;
+    }
+
+    hpm_select(3, HPM_IBUS_WAIT_RAM);
+    perf_results.count = 0;
+    perf_record("dashboard", bench_dashboard);
+    perf_record("memtest", bench_memtest);
+    perf_record("matvec", bench_matvec);
+    perf_record("memcpy", bench_memcpy);
+    perf_record("triad", bench_triad);
+    perf_record("psram_mix", bench_psram_mix);
+    perf_results.magic = PERF_MAGIC;
+
+    /* Results complete - halt here for the runner */
+    while (1);
+}
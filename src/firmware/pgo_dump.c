@@ -0,0 +1,81 @@
+/*
+ * Profile dump for the pgo-gen firmware variant
+ * Serialises the gcov counters into an SDRAM buffer after PGO_FRAMES
+ * frames, then halts. The firmware runner saves
+ * pgo_stream[0..pgo_stream_len) and gcov-tool merge-stream turns it
+ * into .gcda files (see "make pgo-profile").
+ *
+ * Needs GCC 13+ (__gcov_filename_to_gcfn, gcov-tool merge-stream).
+ */
+
+#include <stdint.h>
+#include <gcov.h>
+#include "sections.h"
+
+#ifndef PGO_FRAMES
+#define PGO_FRAMES 4
+#endif
+
+#define PGO_STREAM_SIZE (256 * 1024)
+#define PGO_HEAP_SIZE   (32 * 1024)
+
+#define NO_PROFILE __attribute__((no_profile_instrument_function))
+
+extern const struct gcov_info *const __gcov_info_start[];
+extern const struct gcov_info *const __gcov_info_end[];
+
+/* Read back by the runner through the ELF symbols */
+SDRAM_BSS uint8_t pgo_stream[PGO_STREAM_SIZE];
+volatile uint32_t pgo_stream_len;
+
+/* Bump allocator for __gcov_info_to_gcda's scratch buffers */
+SDRAM_BSS static uint8_t pgo_heap[PGO_HEAP_SIZE];
+static uint32_t pgo_heap_used;
+
+static uint32_t pgo_frames;
+
+NO_PROFILE static void pgo_write(const void *data, unsigned length, void *arg) {
+    const uint8_t *src = data;
+    volatile uint8_t *dst = pgo_stream;
+    (void)arg;
+    for (unsigned i = 0; i < length && pgo_stream_len < PGO_STREAM_SIZE; i++) {
+        dst[pgo_stream_len++] = src[i];
+    }
+}
+
+NO_PROFILE static void pgo_filename(const char *name, void *arg) {
+    __gcov_filename_to_gcfn(name, pgo_write, arg);
+}
+
+NO_PROFILE static void *pgo_allocate(unsigned length, void *arg) {
+    (void)arg;
+    length = (length + 3) & ~3u;
+    if (pgo_heap_used + length > PGO_HEAP_SIZE) {
+        return 0;
+    }
+    void *p = &pgo_heap[pgo_heap_used];
+    pgo_heap_used += length;
+    return p;
+}
+
+NO_PROFILE void frame_hook(void) {
+    if (++pgo_frames < PGO_FRAMES) {
+        return;
+    }
+
+    const struct gcov_info *const *info = __gcov_info_start;
+    const struct gcov_info *const *end = __gcov_info_end;
+
+    /* Keep the compiler from assuming the section is empty */
+    __asm__ ("" : "+r" (info));
+
+    pgo_stream_len = 0;
+    while (info != end) {
+        pgo_heap_used = 0;
+        __gcov_info_to_gcda(*info, pgo_filename, pgo_write, pgo_allocate, 0);
+        info++;
+    }
+
+    /* Profile complete - halt here for the runner */
+    while (1);
+}
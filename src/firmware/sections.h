@@ -0,0 +1,31 @@
+/*
+ * Memory placement helpers
+ * See linker.ld for the region layout
+ *
+ * BRAM is single-cycle but only 64KB, shared with the stack.
+ * SDRAM code/data is reached through the I$/D$, so it suits code that
+ * runs rarely (init, self tests) and large tables read sequentially.
+ */
+
+#ifndef SECTIONS_H
+#define SECTIONS_H
+
+/* Code that must stay in BRAM (inner loops, per-pixel paths) */
+#define HOT          __attribute__((section(".text.hot")))
+
+/* Rarely executed code, placed in SDRAM */
+#define COLD         __attribute__((section(".sdram.text"), noinline, cold))
+
+/* Large constant tables in SDRAM (fonts, lookup tables) */
+#define SDRAM_RODATA __attribute__((section(".sdram.rodata")))
+
+/* Initialised data in SDRAM */
+#define SDRAM_DATA   __attribute__((section(".sdram.data")))
+
+/* Large zero-initialised buffers in SDRAM */
+#define SDRAM_BSS    __attribute__((section(".sdram.bss"), aligned(4)))
+
+/* Zero-initialised scratch buffers in PSRAM */
+#define SCRATCH_BSS  __attribute__((section(".scratch.bss"), aligned(4)))
+
+#endif /* SECTIONS_H */
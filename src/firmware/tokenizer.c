@@ -0,0 +1,191 @@
+/*
+ * Firmware tokenizer
+ * See tokenizer.h; blob format from tools/export_tokenizer.py
+ */
+
+#include "tokenizer.h"
+
+#define TOK_SECTION(tok, off, type) ((const type *)((const uint8_t *)(tok) + (tok)->off))
+
+/* FNV-1a with a seeded basis and a murmur3 finaliser (tok_hash in the exporter) */
+static uint32_t tok_hash(const uint8_t *str, uint32_t len, uint32_t seed) {
+    uint32_t h = 0x811C9DC5u ^ seed;
+    for (uint32_t i = 0; i < len; i++) {
+        h = (h ^ str[i]) * 0x01000193u;
+    }
+    h ^= h >> 16;
+    h *= 0x85EBCA6Bu;
+    h ^= h >> 13;
+    h *= 0xC2B2AE35u;
+    h ^= h >> 16;
+    return h;
+}
+
+static const uint8_t *tok_string(const tok_header_t *tok, uint32_t id, uint32_t *len) {
+    const uint32_t *offsets = TOK_SECTION(tok, off_offsets, uint32_t);
+    *len = offsets[id + 1] - offsets[id];
+    return TOK_SECTION(tok, off_pool, uint8_t) + offsets[id];
+}
+
+int tok_check(const tok_header_t *tok) {
+    return tok->magic == TOK_MAGIC && tok->version == TOK_VERSION;
+}
+
+uint32_t tok_lookup(const tok_header_t *tok, const uint8_t *str, uint32_t len) {
+    const uint32_t *displace = TOK_SECTION(tok, off_displace, uint32_t);
+    const uint32_t *slots = TOK_SECTION(tok, off_slots, uint32_t);
+
+    uint32_t bucket = tok_hash(str, len, 0) & (tok->hash_buckets - 1);
+    uint32_t id = slots[tok_hash(str, len, displace[bucket]) & (tok->hash_slots - 1)];
+    if (id == TOK_NONE) {
+        return TOK_NONE;
+    }
+
+    /* A perfect hash only separates known keys - confirm the match */
+    uint32_t id_len;
+    const uint8_t *s = tok_string(tok, id, &id_len);
+    if (id_len != len) {
+        return TOK_NONE;
+    }
+    for (uint32_t i = 0; i < len; i++) {
+        if (s[i] != str[i]) {
+            return TOK_NONE;
+        }
+    }
+    return id;
+}
+
+/* Merge entry for an adjacent pair, or 0 if the pair never merges */
+static const tok_merge_t *tok_find_merge(const tok_header_t *tok, uint32_t left, uint32_t right) {
+    const tok_merge_t *merges = TOK_SECTION(tok, off_merges, tok_merge_t);
+    uint32_t lo = 0, hi = tok->n_merges;
+    while (lo < hi) {
+        uint32_t mid = (lo + hi) / 2;
+        const tok_merge_t *m = &merges[mid];
+        if (m->left < left || (m->left == left && m->right < right)) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    if (lo < tok->n_merges && merges[lo].left == left && merges[lo].right == right) {
+        return &merges[lo];
+    }
+    return 0;
+}
+
+static uint32_t tok_pair_rank(const tok_header_t *tok, const uint32_t *tokens, uint32_t i) {
+    const tok_merge_t *m = tok_find_merge(tok, tokens[i], tokens[i + 1]);
+    return m ? m->rank : TOK_NONE;
+}
+
+uint32_t tok_encode(const tok_header_t *tok, const char *text, uint32_t len, uint32_t flags,
+                    uint32_t *tokens, uint32_t *work, uint32_t max_tokens) {
+    const uint8_t *c = (const uint8_t *)text;
+    uint32_t byte_base = tok->byte_base != TOK_NONE ? tok->byte_base : 3;
+    uint32_t n = 0;
+
+    if ((flags & TOK_BOS) && n < max_tokens) {
+        tokens[n++] = tok->bos_id;
+    }
+    /* Dummy prefix, as sentencepiece adds */
+    if (len && tok->space_id != TOK_NONE && n < max_tokens) {
+        tokens[n++] = tok->space_id;
+    }
+
+    /* One token per UTF-8 codepoint, or one per byte if it is not in the vocabulary */
+    for (uint32_t i = 0; i < len && n < max_tokens;) {
+        uint32_t cp_len = 1;
+        while (i + cp_len < len && cp_len < 4 && (c[i + cp_len] & 0xC0) == 0x80) {
+            cp_len++;
+        }
+        uint32_t id = tok_lookup(tok, &c[i], cp_len);
+        if (id != TOK_NONE) {
+            tokens[n++] = id;
+        } else {
+            for (uint32_t j = 0; j < cp_len && n < max_tokens; j++) {
+                tokens[n++] = byte_base + c[i + j];
+            }
+        }
+        i += cp_len;
+    }
+
+    /* work[i] caches the merge rank of pair (i, i + 1) */
+    for (uint32_t i = 0; i + 1 < n; i++) {
+        work[i] = tok_pair_rank(tok, tokens, i);
+    }
+
+    /* Merge the best pair until none is left, leftmost first on ties */
+    while (n > 1) {
+        uint32_t best = 0;
+        uint32_t best_rank = TOK_NONE;
+        for (uint32_t i = 0; i + 1 < n; i++) {
+            if (work[i] < best_rank) {
+                best_rank = work[i];
+                best = i;
+            }
+        }
+        if (best_rank == TOK_NONE) {
+            break;
+        }
+
+        tokens[best] = tok_find_merge(tok, tokens[best], tokens[best + 1])->id;
+        for (uint32_t i = best + 1; i + 1 < n; i++) {
+            tokens[i] = tokens[i + 1];
+            work[i] = work[i + 1];
+        }
+        n--;
+
+        /* Only the pairs either side of the merged token changed */
+        if (best > 0) {
+            work[best - 1] = tok_pair_rank(tok, tokens, best - 1);
+        }
+        if (best + 1 < n) {
+            work[best] = tok_pair_rank(tok, tokens, best);
+        }
+    }
+
+    if ((flags & TOK_EOS) && n < max_tokens) {
+        tokens[n++] = tok->eos_id;
+    }
+    return n;
+}
+
+static int tok_hex(uint8_t c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    return -1;
+}
+
+uint32_t tok_decode(const tok_header_t *tok, uint32_t prev, uint32_t token,
+                    char *out, uint32_t out_size) {
+    if (token >= tok->vocab_size) {
+        return 0;
+    }
+    uint32_t len;
+    const uint8_t *s = tok_string(tok, token, &len);
+
+    /* After BOS, sentencepiece drops the leading space */
+    if (prev == tok->bos_id && len && s[0] == ' ') {
+        s++;
+        len--;
+    }
+
+    /* Raw byte tokens: <0xXX> */
+    uint8_t byte;
+    if (len == 6 && s[0] == '<' && s[1] == '0' && s[2] == 'x' && s[5] == '>' &&
+        tok_hex(s[3]) >= 0 && tok_hex(s[4]) >= 0) {
+        byte = (uint8_t)(tok_hex(s[3]) << 4 | tok_hex(s[4]));
+        s = &byte;
+        len = 1;
+    }
+
+    if (len > out_size) {
+        len = out_size;
+    }
+    for (uint32_t i = 0; i < len; i++) {
+        out[i] = (char)s[i];
+    }
+    return len;
+}
@@ -0,0 +1,77 @@
+/*
+ * Firmware tokenizer
+ * Encodes and decodes with the blob written by tools/export_tokenizer.py
+ *
+ * Same results as llama2.c's encode()/decode(), without string scans:
+ * codepoints are looked up through a perfect hash, and merges through a
+ * merge table sorted by (left, right) id pair, so each lookup is one
+ * hash or one binary search.
+ *
+ * The blob is used in place (e.g. loaded into SDRAM by a data slot);
+ * it must be 4-byte aligned.
+ */
+
+#ifndef TOKENIZER_H
+#define TOKENIZER_H
+
+#include <stdint.h>
+
+#define TOK_MAGIC   0x424B4F54  /* "TOKB" */
+#define TOK_VERSION 1
+#define TOK_NONE    0xFFFFFFFFu
+
+/* tok_encode() flags */
+#define TOK_BOS     (1 << 0)    /* Prepend the BOS token */
+#define TOK_EOS     (1 << 1)    /* Append the EOS token */
+
+/* Blob header; offsets are bytes from the blob start */
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t blob_bytes;
+    uint32_t vocab_size;
+    uint32_t max_token_len;
+    uint32_t bos_id;
+    uint32_t eos_id;
+    uint32_t byte_base;     /* Id of <0x00>, TOK_NONE if absent */
+    uint32_t space_id;      /* Id of " " (dummy prefix), TOK_NONE if absent */
+    uint32_t hash_buckets;  /* Power of two */
+    uint32_t hash_slots;    /* Power of two */
+    uint32_t n_merges;
+    uint32_t off_displace;  /* uint32_t[hash_buckets] */
+    uint32_t off_slots;     /* uint32_t[hash_slots], token id or TOK_NONE */
+    uint32_t off_merges;    /* tok_merge_t[n_merges], sorted by (left, right) */
+    uint32_t off_offsets;   /* uint32_t[vocab_size + 1] into the pool */
+    uint32_t off_pool;      /* Token bytes, back to back */
+} tok_header_t;
+
+typedef struct {
+    uint32_t left;
+    uint32_t right;
+    uint32_t id;            /* Token left + right merge into */
+    uint32_t rank;          /* Lower merges first */
+} tok_merge_t;
+
+/* Non-zero if blob looks like a tokenizer this code understands */
+int tok_check(const tok_header_t *tok);
+
+/* Id of a token string, TOK_NONE if not in the vocabulary */
+uint32_t tok_lookup(const tok_header_t *tok, const uint8_t *str, uint32_t len);
+
+/*
+ * Encode len bytes of UTF-8 text into tokens[0..max_tokens).
+ * work needs max_tokens entries of scratch. Returns the token count;
+ * text beyond max_tokens is dropped.
+ */
+uint32_t tok_encode(const tok_header_t *tok, const char *text, uint32_t len, uint32_t flags,
+                    uint32_t *tokens, uint32_t *work, uint32_t max_tokens);
+
+/*
+ * Text of token following prev, as llama2.c prints it: the leading space
+ * is dropped after BOS and <0xXX> tokens become their byte. Copies at
+ * most out_size bytes to out and returns the number copied.
+ */
+uint32_t tok_decode(const tok_header_t *tok, uint32_t prev, uint32_t token,
+                    char *out, uint32_t out_size);
+
+#endif /* TOKENIZER_H */
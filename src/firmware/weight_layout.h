@@ -0,0 +1,83 @@
+/*
+ * Accelerator weight layout table
+ * Written by tools/export_layout.py at the start of the model image
+ *
+ * Weights are Q16.16, or Q4_Q16 blocks for entries flagged WL_FLAG_Q4
+ * (5 words per 32 elements, fetched with the DMA's CTRL q4_mode). Entry
+ * offsets count bytes from the image start; strides count 32-bit words,
+ * which for Q16.16 are elements. Every
+ * tensor starts on a 2KB SDRAM page (one io_sdram row, 512 words). Rows
+ * of up to a page use a power-of-two stride so a row burst never crosses
+ * a page; longer rows start on a page.
+ *
+ * Tiled matrices are split into blocks of tile_rows rows packed back to
+ * back, so one block is a single weight cache load (at most 4096
+ * elements, Q16.16 only). Each block starts on a page; select a row inside it with
+ * CACHE_ROW_OFFSET = (row % tile_rows) * row_stride.
+ */
+
+#ifndef WEIGHT_LAYOUT_H
+#define WEIGHT_LAYOUT_H
+
+#include <stdint.h>
+
+#define WL_MAGIC          0x59414C57  /* "WLAY" */
+#define WL_VERSION        1
+#define WL_PAGE_BYTES     2048
+#define WL_CACHE_ELEMENTS 4096
+#define WL_NAME_LEN       40
+
+#define WL_FLAG_TILED     (1 << 0)
+#define WL_FLAG_Q4        (1 << 1)  /* Rows are Q4_Q16 blocks */
+
+/* Table header at image offset 0, entries follow */
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t n_entries;
+    uint32_t image_bytes;     /* Total image size */
+} wl_header_t;
+
+typedef struct {
+    char     name[WL_NAME_LEN];  /* GGUF tensor name, NUL padded */
+    uint32_t offset;             /* Bytes from image start (page aligned) */
+    uint32_t rows;
+    uint32_t cols;               /* Elements per row */
+    uint32_t row_stride;         /* Words between rows (within a tile) */
+    uint16_t tile_rows;          /* Rows per weight cache block, 0 if untiled */
+    uint16_t flags;
+    uint32_t tile_stride;        /* Words between blocks */
+} wl_entry_t;
+
+static inline const wl_entry_t *wl_entries(const wl_header_t *hdr) {
+    return (const wl_entry_t *)(hdr + 1);
+}
+
+/* Look up a tensor by name, NULL if absent */
+static inline const wl_entry_t *wl_find(const wl_header_t *hdr, const char *name) {
+    const wl_entry_t *e = wl_entries(hdr);
+    for (uint32_t i = 0; i < hdr->n_entries; i++, e++) {
+        int j = 0;
+        while (j < WL_NAME_LEN && e->name[j] == name[j] && name[j]) j++;
+        if (j == WL_NAME_LEN || e->name[j] == name[j]) return e;
+    }
+    return 0;
+}
+
+/* Word offset of a row from the start of the tensor */
+static inline uint32_t wl_row_element(const wl_entry_t *e, uint32_t row) {
+    if (e->flags & WL_FLAG_TILED) {
+        return (row / e->tile_rows) * e->tile_stride + (row % e->tile_rows) * e->row_stride;
+    }
+    return row * e->row_stride;
+}
+
+/*
+ * DMA word address (ADDR_A/ADDR_B/CACHE_ADDR) of a row, given the SDRAM
+ * byte offset the image was loaded at
+ */
+static inline uint32_t wl_row_addr(const wl_entry_t *e, uint32_t image_sdram_offset, uint32_t row) {
+    return ((image_sdram_offset + e->offset) >> 2) + wl_row_element(e, row);
+}
+
+#endif /* WEIGHT_LAYOUT_H */
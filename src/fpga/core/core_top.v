@@ -319,8 +319,18 @@ wire        cpu_sdram_rd;
 wire        cpu_sdram_wr;
 wire [23:0] cpu_sdram_addr;
 wire [31:0] cpu_sdram_wdata;
+wire [3:0]  cpu_sdram_wstrb;
+wire [1:0]  cpu_sdram_tag;
 wire [31:0] cpu_sdram_rdata;
-wire        cpu_sdram_busy;
+wire        cpu_sdram_ready;
+wire        cpu_sdram_rdata_valid;
+wire [1:0]  cpu_sdram_rdata_tag;
+
+// io_sdram statistics: snapshot/restart from the CPU (SYS_SDRAM_STAT_CTRL)
+// or the bridge, read back by either
+wire        cpu_sdram_stat_snapshot;
+wire        cpu_sdram_stat_clear;
+wire [415:0] sdram_stats;
 
 // CPU to PSRAM interface
 wire        cpu_psram_rd;
@@ -358,12 +368,37 @@ always @(*) begin
         // SDRAM mapped at 0x00000000 - 0x03FFFFFF (64MB)
         bridge_rd_data <= bridge_rd_data_captured;
     end
+    32'h400000xx: begin
+        // io_sdram statistics at the SYS_SDRAM_STAT_* offsets (0x40-0x70).
+        // The snapshot only changes on SYS_SDRAM_STAT_CTRL, so it is
+        // stable by the time the host reads it.
+        if (bridge_addr[7:6] == 2'b01 && bridge_addr[5:2] < 4'd13)
+            bridge_rd_data <= sdram_stats[bridge_addr[5:2]*32 +: 32];
+        else
+            bridge_rd_data <= 0;
+    end
     32'hF8xxxxxx: begin
         bridge_rd_data <= cmd_bridge_rd_data;
     end
     endcase
 end
 
+// Bridge write to SYS_SDRAM_STAT_CTRL (0x4000001C): the bits are held in
+// clk_74a and a toggle carries the request over to clk_ram_controller
+reg [1:0] bridge_stat_ctrl;
+reg bridge_stat_toggle;
+reg [2:0] bridge_stat_toggle_sync;
+always @(posedge clk_74a) begin
+    if (bridge_wr && bridge_addr == 32'h4000001C) begin
+        bridge_stat_ctrl <= bridge_wr_data[1:0];
+        bridge_stat_toggle <= ~bridge_stat_toggle;
+    end
+end
+always @(posedge clk_ram_controller) begin
+    bridge_stat_toggle_sync <= {bridge_stat_toggle_sync[1:0], bridge_stat_toggle};
+end
+wire bridge_stat_ctrl_wr = bridge_stat_toggle_sync[2] ^ bridge_stat_toggle_sync[1];
+
 // Synchronize bridge signals from clk_74a to clk_ram_controller
 reg [31:0] bridge_addr_captured;
 reg [31:0] bridge_wr_data_captured;
@@ -460,12 +495,9 @@ always @(posedge clk_ram_controller) begin
     if (!bridge_rd_sync1) bridge_rd_done <= 0;
 end
 
-// Bridge is active from sync3 through done (when we're processing)
-wire bridge_wr_active = bridge_wr_sync3 | bridge_wr_sync4 | bridge_wr_done;
-wire bridge_rd_active = bridge_rd_sync3 | bridge_rd_sync4 | bridge_rd_pending | bridge_rd_done;
-
-// SDRAM access arbiter - runs at SDRAM controller clock (133 MHz)
-// Bridge has priority, CPU runs when bridge is idle
+// Bridge SDRAM requests - runs at SDRAM controller clock (133 MHz)
+// The CPU uses io_sdram's sync_word port directly; io_sdram serves
+// bridge word requests first
 always @(posedge clk_ram_controller) begin
     ram1_word_rd <= 0;
     ram1_word_wr <= 0;
@@ -481,23 +513,11 @@ always @(posedge clk_ram_controller) begin
         // Bridge read - data is now stable in bridge_addr_ram_clk
         ram1_word_rd <= 1;
         ram1_word_addr <= bridge_addr_ram_clk[25:2];
-    end else if (!bridge_wr_active && !bridge_rd_active) begin
-        // CPU SDRAM access - same clock domain, direct connection
-        // Use else-if to prevent undefined behavior if both rd and wr are asserted
-        if (cpu_sdram_rd) begin
-            ram1_word_rd <= 1;
-            ram1_word_addr <= cpu_sdram_addr;
-        end else if (cpu_sdram_wr) begin
-            ram1_word_wr <= 1;
-            ram1_word_addr <= cpu_sdram_addr;
-            ram1_word_data <= cpu_sdram_wdata;
-        end
     end
 end
 
 // CPU reads SDRAM data - direct connection (same clock domain)
 assign cpu_sdram_rdata = ram1_word_q;
-assign cpu_sdram_busy = ram1_word_busy;
 
 
 //
@@ -749,14 +769,20 @@ assign video_hs = vidout_hs;
         .term_mem_wstrb(term_mem_wstrb),
         .term_mem_rdata(term_mem_rdata),
         .term_mem_ready(term_mem_ready),
-        // SDRAM interface (directly to io_sdram word interface via core_top)
+        // SDRAM interface (directly to io_sdram sync_word port)
         .sdram_rd(cpu_sdram_rd),
         .sdram_wr(cpu_sdram_wr),
         .sdram_addr(cpu_sdram_addr),
         .sdram_wdata(cpu_sdram_wdata),
+        .sdram_wstrb(cpu_sdram_wstrb),
+        .sdram_tag(cpu_sdram_tag),
         .sdram_rdata(cpu_sdram_rdata),
-        .sdram_busy(cpu_sdram_busy),
-        .sdram_rdata_valid(ram1_word_q_valid),
+        .sdram_ready(cpu_sdram_ready),
+        .sdram_rdata_valid(cpu_sdram_rdata_valid),
+        .sdram_rdata_tag(cpu_sdram_rdata_tag),
+        .sdram_stat_snapshot(cpu_sdram_stat_snapshot),
+        .sdram_stat_clear(cpu_sdram_stat_clear),
+        .sdram_stats(sdram_stats),
         // PSRAM interface (to psram_controller)
         .psram_rd(cpu_psram_rd),
         .psram_wr(cpu_psram_wr),
@@ -975,9 +1001,11 @@ mf_pllbase mp1 (
 
 
 // SDRAM controller using io_sdram from example
-// Uses word interface for both bridge writes and CPU access
+// Word interface for bridge access, sync_word interface for the CPU
+// Bank-XOR address mapping: the framebuffers, firmware image and weights
+// start in different banks (sim_soc.v and tb_soc.cpp must agree)
 
-io_sdram isr0 (
+io_sdram #(.ADDR_MAP(2)) isr0 (
     .controller_clk ( clk_ram_controller ),
     .chip_clk       ( clk_ram_chip ),
     .clk_90         ( clk_ram_90 ),
@@ -1010,14 +1038,31 @@ io_sdram isr0 (
     .burstwr_data   ( 16'b0 ),
     .burstwr_done   ( 1'b0 ),
 
-    // Word interface - used for bridge writes and CPU access
+    // Word interface - used for bridge access (synchronized inside io_sdram)
     .word_rd    ( ram1_word_rd ),
     .word_wr    ( ram1_word_wr ),
     .word_addr  ( ram1_word_addr ),
     .word_data  ( ram1_word_data ),
     .word_q     ( ram1_word_q ),
     .word_busy  ( ram1_word_busy ),
-    .word_q_valid ( ram1_word_q_valid )
+    .word_q_valid ( ram1_word_q_valid ),
+
+    // Same-clock word interface - used for CPU access
+    .sync_word_valid    ( cpu_sdram_rd | cpu_sdram_wr ),
+    .sync_word_wr       ( cpu_sdram_wr ),
+    .sync_word_addr     ( cpu_sdram_addr ),
+    .sync_word_data     ( cpu_sdram_wdata ),
+    .sync_word_tag      ( cpu_sdram_tag ),
+    .sync_word_mask     ( cpu_sdram_wstrb ),
+    .sync_word_ready    ( cpu_sdram_ready ),
+    .sync_word_q_valid  ( cpu_sdram_rdata_valid ),
+    .sync_word_q_tag    ( cpu_sdram_rdata_tag ),
+
+    .refresh_urgent     ( ),    // only observed in simulation (sim_soc)
+
+    .stat_snapshot      ( cpu_sdram_stat_snapshot | (bridge_stat_ctrl_wr & bridge_stat_ctrl[0]) ),
+    .stat_clear         ( cpu_sdram_stat_clear | (bridge_stat_ctrl_wr & bridge_stat_ctrl[1]) ),
+    .stats              ( sdram_stats )
 
 );
 
@@ -25,15 +25,27 @@ module cpu_system (
     input wire  [31:0] term_mem_rdata,
     input wire         term_mem_ready,
 
-    // SDRAM word interface (directly to io_sdram via core_top)
-    // CPU and SDRAM controller run at same clock (133 MHz)
+    // SDRAM word interface (io_sdram sync_word port via core_top)
+    // CPU and SDRAM controller run at same clock (133 MHz), so requests
+    // use a valid/ready handshake with no synchronizer: sdram_rd/sdram_wr
+    // are held until sdram_ready, and a write is done once accepted.
+    // Reads are tagged with the bus that issued them (BUS_IBUS/BUS_DBUS)
+    // and may complete out of order.
     output reg         sdram_rd,
     output reg         sdram_wr,
     output reg  [23:0] sdram_addr,
     output reg  [31:0] sdram_wdata,
+    output reg  [3:0]  sdram_wstrb,        // byte enables of a write
+    output reg  [1:0]  sdram_tag,
     input wire  [31:0] sdram_rdata,
-    input wire         sdram_busy,
+    input wire         sdram_ready,
     input wire         sdram_rdata_valid,  // Pulses when read data is valid
+    input wire  [1:0]  sdram_rdata_tag,    // ... for the read with this tag
+
+    // io_sdram statistics (SYS_SDRAM_STAT_*)
+    output wire        sdram_stat_snapshot,
+    output wire        sdram_stat_clear,
+    input wire  [415:0] sdram_stats,       // 13 counters as of the last snapshot
 
     // PSRAM word interface (to psram_controller via core_top)
     output reg         psram_rd,
@@ -80,6 +92,9 @@ wire [2:0]  dbus_cti;
 // Active-high reset for VexRiscv
 wire reset = ~reset_n;
 
+// Hardware events for mhpmcounter3-6, one bit per HPM_* index
+wire [31:0] hpm_events;
+
 // Instantiate VexRiscv CPU
 VexRiscv cpu (
     .clk(clk),
@@ -93,6 +108,9 @@ VexRiscv cpu (
     .softwareInterrupt(1'b0),
     .externalInterruptArray(32'b0),
 
+    // Event counters (mhpmevent selects a bit)
+    .hpmEvents(hpm_events),
+
     // Instruction Wishbone bus
     .iBusWishbone_CYC(ibus_cyc),
     .iBusWishbone_STB(ibus_stb),
@@ -121,24 +139,19 @@ VexRiscv cpu (
 );
 
 // ============================================
-// Arbitrated memory interface
+// Bus interconnect
 // ============================================
-// Data bus has priority over instruction bus
-// Convert Wishbone to simple valid/ready protocol
-
-wire ibus_req = ibus_cyc & ibus_stb & ~ibus_ack;
-wire dbus_req = dbus_cyc & dbus_stb & ~dbus_ack;
+// A small crossbar: each Wishbone bus decodes its own request, and each
+// target (BRAM, SDRAM, PSRAM, terminal, sysregs) takes one request per
+// cycle from either bus, the data bus first when both want the same one.
+// A bus has one access in flight, so a PSRAM load on the data bus no
+// longer holds up instruction fetch from BRAM, and vice versa.
+// An SDRAM read is tagged with its bus and completes by tag, so each
+// bus can have one in flight while the other proceeds.
 
-// Grant: data has priority
-wire dbus_grant = dbus_req;
-wire ibus_grant = ibus_req & ~dbus_req;
-
-// Muxed memory interface signals
-wire        mem_valid = dbus_grant | ibus_grant;
-wire [31:0] mem_addr  = dbus_grant ? {dbus_adr, 2'b00} : {ibus_adr, 2'b00};
-wire [31:0] mem_wdata = dbus_dat_mosi;
-wire [3:0]  mem_wstrb = dbus_grant ? (dbus_we ? dbus_sel : 4'b0) : 4'b0;
-wire        mem_write = dbus_grant & dbus_we;
+localparam BUS_NONE = 2'd0;
+localparam BUS_IBUS = 2'd1;
+localparam BUS_DBUS = 2'd2;
 
 // Memory map:
 // 0x00000000 - 0x0000FFFF : RAM (64KB)
@@ -148,20 +161,149 @@ wire        mem_write = dbus_grant & dbus_we;
 // 0x20000000 - 0x20001FFF : Terminal VRAM
 // 0x30000000 - 0x30FFFFFF : PSRAM (16MB) - cram0 chip
 // 0x40000000 - 0x400000FF : System registers
+// 0x90000000 - 0x93FFFFFF : SDRAM again, uncached (outside the D$ range)
+//   with stores merged in a write-combining buffer
+
+localparam T_NONE   = 3'd0;   // unmapped: reads 0, acked at once
+localparam T_RAM    = 3'd1;
+localparam T_SDRAM  = 3'd2;   // SDRAM request register, either alias
+localparam T_WC     = 3'd3;   // store to the write-combining alias
+localparam T_TERM   = 3'd4;
+localparam T_PSRAM  = 3'd5;
+localparam T_SYSREG = 3'd6;
+
+function [2:0] decode_target;
+    input [31:0] addr;
+    input        write;
+    begin
+        if (addr[31:16] == 16'b0)                // 0x00000000-0x0000FFFF (64KB)
+            decode_target = T_RAM;
+        else if (addr[31:26] == 6'b000100)       // 0x10000000-0x13FFFFFF (64MB)
+            decode_target = T_SDRAM;
+        else if (addr[31:26] == 6'b100100)       // 0x90000000-0x93FFFFFF (64MB)
+            decode_target = write ? T_WC : T_SDRAM;
+        else if (addr[31:13] == 19'h10000)       // 0x20000000-0x20001FFF
+            decode_target = T_TERM;
+        else if (addr[31:24] == 8'h30)           // 0x30000000-0x30FFFFFF (16MB)
+            decode_target = T_PSRAM;
+        else if (addr[31:8] == 24'h400000)       // 0x40000000-0x400000FF
+            decode_target = T_SYSREG;
+        else
+            decode_target = T_NONE;
+    end
+endfunction
+
+// Access in flight on each bus, cleared when it is acked
+reg ibus_busy;
+reg dbus_busy;
+reg sdram_read_ibus;
+reg sdram_read_dbus;
+
+wire ibus_req = ibus_cyc & ibus_stb & ~ibus_ack & ~ibus_busy & ~sdram_read_ibus;
+wire dbus_req = dbus_cyc & dbus_stb & ~dbus_ack & ~dbus_busy & ~sdram_read_dbus;
+
+wire [31:0] ibus_addr   = {ibus_adr, 2'b00};
+wire [31:0] dbus_addr   = {dbus_adr, 2'b00};
+wire [3:0]  dbus_wstrb  = dbus_we ? dbus_sel : 4'b0;
+wire [2:0]  ibus_target = decode_target(ibus_addr, 1'b0);
+wire [2:0]  dbus_target = decode_target(dbus_addr, dbus_we);
+
+// Targets with an access in flight
+reg [1:0] term_bus;
+reg [1:0] psram_bus;
+reg [1:0] ram_bus;                   // read data is on ram_rdata this cycle
+reg sdram_write_pending;             // data bus write waiting for sdram_ready
+reg psram_read_pending;
+reg psram_write_pending;
+reg psram_write_started;
 
-// Decode memory regions
-wire ram_select    = (mem_addr[31:16] == 16'b0);                    // 0x00000000-0x0000FFFF (64KB)
-wire sdram_select  = (mem_addr[31:26] == 6'b000100);                // 0x10000000-0x13FFFFFF (64MB)
-wire term_select   = (mem_addr[31:13] == 19'h10000);                // 0x20000000-0x20001FFF
-wire psram_select  = (mem_addr[31:24] == 8'h30);                    // 0x30000000-0x30FFFFFF (16MB)
-wire sysreg_select = (mem_addr[31:8] == 24'h400000);                // 0x40000000-0x400000FF
+// The SDRAM request register can take a new request this cycle
+wire sdram_free = ~(sdram_rd | sdram_wr) | sdram_ready;
+
+// Write-combining buffer for the uncached SDRAM alias. Stores to one
+// WC_WORDS-word block are merged (with byte enables) and acknowledged at
+// once. The buffer drains as SDRAM writes in address order, which
+// io_sdram chains into one row burst, when a store leaves the block,
+// after WC_TIMEOUT cycles without a store, or before any SDRAM or
+// sysreg access. A sysreg read is the firmware's fence: a RISC-V fence
+// is not visible on the bus.
+localparam WC_WORDS = 8;
+localparam WC_TIMEOUT = 6'd63;
+
+reg [31:0] wc_data [0:WC_WORDS-1];
+reg [3:0]  wc_mask [0:WC_WORDS-1];
+reg [20:0] wc_block;                 // SDRAM word address [23:3] of the buffered stores
+reg        wc_dirty;                 // buffer holds stores
+reg        wc_flush;                 // buffer is draining
+reg [2:0]  wc_idx;                   // next word to drain
+reg [5:0]  wc_idle;                  // cycles since the last store, saturating
+integer    wc_i;
+
+// Accesses that must wait until the buffer has drained
+wire ibus_wc_stall = wc_dirty && (ibus_target == T_SDRAM || ibus_target == T_SYSREG);
+wire dbus_wc_stall = wc_dirty && (dbus_target == T_SDRAM || dbus_target == T_SYSREG ||
+                                  (dbus_target == T_WC &&
+                                   (wc_flush || dbus_addr[25:5] != wc_block)));
+
+wire ibus_target_free = ibus_target == T_SDRAM ? sdram_free && !wc_flush :
+                        ibus_target == T_TERM  ? term_bus == BUS_NONE :
+                        ibus_target == T_PSRAM ? psram_bus == BUS_NONE : 1'b1;
+wire dbus_target_free = dbus_target == T_SDRAM ? sdram_free && !wc_flush :
+                        dbus_target == T_TERM  ? term_bus == BUS_NONE :
+                        dbus_target == T_PSRAM ? psram_bus == BUS_NONE : 1'b1;
+
+// Grants: data bus first when both want the same target
+wire dbus_go = dbus_req && dbus_target_free && !dbus_wc_stall;
+wire ibus_go = ibus_req && ibus_target_free && !ibus_wc_stall &&
+               !(dbus_go && dbus_target == ibus_target);
+
+// Performance monitor events (HPM_* in firmware csr.h). The wait events
+// count every cycle an access to that target is outstanding on the bus,
+// so arbitration, WC-drain and memory latency all show up. Bit 0 is the
+// "off" event and stays low.
+localparam HPM_ICACHE_REFILL    = 1;
+localparam HPM_DCACHE_REFILL    = 2;
+localparam HPM_DBUS_WRITE       = 3;
+localparam HPM_IBUS_WAIT_RAM    = 4;
+localparam HPM_IBUS_WAIT_SDRAM  = 5;
+localparam HPM_IBUS_WAIT_PSRAM  = 6;
+localparam HPM_DBUS_WAIT_RAM    = 7;
+localparam HPM_DBUS_WAIT_SDRAM  = 8;
+localparam HPM_DBUS_WAIT_PSRAM  = 9;
+localparam HPM_DBUS_WAIT_TERM   = 10;
+localparam HPM_DBUS_WAIT_SYSREG = 11;
+localparam HPM_WC_DRAIN         = 12;
+
+wire ibus_wait = ibus_cyc & ibus_stb & ~ibus_ack;
+wire dbus_wait = dbus_cyc & dbus_stb & ~dbus_ack;
+
+// Cache refills are bursts; their last beat is the only CTI 3'b111 ack
+// (uncached data accesses are classic cycles, CTI 3'b000)
+assign hpm_events[0]                    = 1'b0;
+assign hpm_events[HPM_ICACHE_REFILL]    = ibus_ack && ibus_cti == 3'b111;
+assign hpm_events[HPM_DCACHE_REFILL]    = dbus_ack && !dbus_we && dbus_cti == 3'b111;
+assign hpm_events[HPM_DBUS_WRITE]       = dbus_ack && dbus_we;
+assign hpm_events[HPM_IBUS_WAIT_RAM]    = ibus_wait && ibus_target == T_RAM;
+assign hpm_events[HPM_IBUS_WAIT_SDRAM]  = ibus_wait && ibus_target == T_SDRAM;
+assign hpm_events[HPM_IBUS_WAIT_PSRAM]  = ibus_wait && ibus_target == T_PSRAM;
+assign hpm_events[HPM_DBUS_WAIT_RAM]    = dbus_wait && dbus_target == T_RAM;
+assign hpm_events[HPM_DBUS_WAIT_SDRAM]  = dbus_wait && (dbus_target == T_SDRAM ||
+                                                        dbus_target == T_WC);
+assign hpm_events[HPM_DBUS_WAIT_PSRAM]  = dbus_wait && dbus_target == T_PSRAM;
+assign hpm_events[HPM_DBUS_WAIT_TERM]   = dbus_wait && dbus_target == T_TERM;
+assign hpm_events[HPM_DBUS_WAIT_SYSREG] = dbus_wait && dbus_target == T_SYSREG;
+assign hpm_events[HPM_WC_DRAIN]         = wc_flush;
+assign hpm_events[31:13]                = 19'b0;
 
 // ============================================
 // RAM using block RAM (64KB = 16384 x 32-bit words)
 // ============================================
+wire ram_go_dbus = dbus_go && dbus_target == T_RAM;
+wire ram_go_ibus = ibus_go && ibus_target == T_RAM;
+
 wire [31:0] ram_rdata;
-wire [13:0] ram_addr_mux = mem_addr[15:2];
-wire ram_wren = mem_valid && ram_select && |mem_wstrb;
+wire [13:0] ram_addr_mux = ram_go_dbus ? dbus_addr[15:2] : ibus_addr[15:2];
+wire ram_wren = ram_go_dbus && |dbus_wstrb;
 
 altsyncram #(
     .operation_mode("SINGLE_PORT"),
@@ -177,9 +319,9 @@ altsyncram #(
 ) ram (
     .clock0(clk),
     .address_a(ram_addr_mux),
-    .data_a(mem_wdata),
+    .data_a(dbus_dat_mosi),
     .wren_a(ram_wren),
-    .byteena_a(mem_wstrb),
+    .byteena_a(dbus_wstrb),
     .q_a(ram_rdata),
     // Unused ports
     .aclr0(1'b0),
@@ -201,11 +343,15 @@ altsyncram #(
     .wren_b(1'b0)
 );
 
-// Forward terminal requests to terminal module
-assign term_mem_valid = mem_valid && term_select;
-assign term_mem_addr = mem_addr;
-assign term_mem_wdata = mem_wdata;
-assign term_mem_wstrb = mem_wstrb;
+// Forward terminal requests to terminal module; valid is held from the
+// grant until the terminal is ready
+wire term_go_dbus = dbus_go && dbus_target == T_TERM;
+wire term_go_ibus = ibus_go && ibus_target == T_TERM;
+wire term_dbus = term_bus == BUS_DBUS || term_go_dbus;
+assign term_mem_valid = term_bus != BUS_NONE || term_go_dbus || term_go_ibus;
+assign term_mem_addr = term_dbus ? dbus_addr : ibus_addr;
+assign term_mem_wdata = dbus_dat_mosi;
+assign term_mem_wstrb = term_dbus ? dbus_wstrb : 4'b0;
 
 // ============================================
 // System registers
@@ -217,8 +363,17 @@ assign term_mem_wstrb = mem_wstrb;
 // 0x10: SYS_FB_DISPLAY   - Display framebuffer SDRAM address (read-only)
 // 0x14: SYS_FB_DRAW      - Draw framebuffer SDRAM address (read-only)
 // 0x18: SYS_FB_SWAP      - Write 1 to swap buffers (on next vsync)
+// 0x1C: SYS_SDRAM_STAT_CTRL - Write bit 0 to snapshot the io_sdram counters,
+//                          bit 1 to restart them (both: snapshot, then restart)
+// 0x40-0x70: SYS_SDRAM_STAT_* - io_sdram counters as of the last snapshot
 // 0x0C: SYS_DISPLAY_MODE - 0=terminal overlay, 1=framebuffer only
 
+// Sysreg accesses complete in the cycle they are granted
+wire sysreg_go_dbus = dbus_go && dbus_target == T_SYSREG;
+wire sysreg_go_ibus = ibus_go && ibus_target == T_SYSREG;
+wire [5:0] sysreg_index = sysreg_go_dbus ? dbus_addr[7:2] : ibus_addr[7:2];
+wire sysreg_wr = sysreg_go_dbus && |dbus_wstrb;
+
 reg [31:0] sysreg_rdata;
 reg [63:0] cycle_counter;
 reg display_mode_reg;  // 0=terminal overlay, 1=framebuffer only
@@ -268,20 +423,25 @@ always @(posedge clk) begin
         end
 
         // Write to display mode register (0x4000000C)
-        if (mem_valid && sysreg_select && |mem_wstrb && mem_addr[7:2] == 6'b000011) begin
-            display_mode_reg <= mem_wdata[0];
+        if (sysreg_wr && sysreg_index == 6'b000011) begin
+            display_mode_reg <= dbus_dat_mosi[0];
         end
 
         // Write to swap register (0x40000018) - request buffer swap
-        if (mem_valid && sysreg_select && |mem_wstrb && mem_addr[7:2] == 6'b000110) begin
-            if (mem_wdata[0])
+        if (sysreg_wr && sysreg_index == 6'b000110) begin
+            if (dbus_dat_mosi[0])
                 fb_swap_pending <= 1;
         end
     end
 end
 
+// SYS_SDRAM_STAT_CTRL write: one pulse per store
+wire sdram_stat_ctrl_wr = sysreg_wr && sysreg_index == 6'b000111;
+assign sdram_stat_snapshot = sdram_stat_ctrl_wr && dbus_dat_mosi[0];
+assign sdram_stat_clear = sdram_stat_ctrl_wr && dbus_dat_mosi[1];
+
 always @(*) begin
-    case (mem_addr[7:2])
+    case (sysreg_index)
         6'b000000: sysreg_rdata = {30'b0, dataslot_allcomplete_s, 1'b1};  // SYS_STATUS
         6'b000001: sysreg_rdata = cycle_counter[31:0];   // SYS_CYCLE_LO
         6'b000010: sysreg_rdata = cycle_counter[63:32];  // SYS_CYCLE_HI
@@ -289,32 +449,44 @@ always @(*) begin
         6'b000100: sysreg_rdata = {7'b0, fb_display_addr_reg};  // SYS_FB_DISPLAY
         6'b000101: sysreg_rdata = {7'b0, fb_draw_addr_reg};     // SYS_FB_DRAW
         6'b000110: sysreg_rdata = {31'b0, fb_swap_pending};     // SYS_FB_SWAP
-        default: sysreg_rdata = 32'h0;
+        default: begin
+            // SYS_SDRAM_STAT_* (io_sdram STAT_* order)
+            if (sysreg_index[5:4] == 2'b01 && sysreg_index[3:0] < 4'd13)
+                sysreg_rdata = sdram_stats[sysreg_index[3:0]*32 +: 32];
+            else
+                sysreg_rdata = 32'h0;
+        end
     endcase
 end
 
 // ============================================
-// Memory access state machine
+// Per-target channels
 // ============================================
-// Handle RAM, SDRAM, terminal, and sysreg accesses
-// Generate Wishbone ACK when complete
-
-reg mem_pending;
-reg [1:0] pending_bus;  // 0=none, 1=ibus, 2=dbus
-reg ram_pending;
-reg term_pending;
-reg sdram_read_pending;
-reg sdram_write_pending;
-reg sdram_write_started;
-reg psram_read_pending;
-reg psram_write_pending;
-reg psram_write_started;
-reg sysreg_pending;
-reg [31:0] pending_rdata;
-
-localparam BUS_NONE = 2'd0;
-localparam BUS_IBUS = 2'd1;
-localparam BUS_DBUS = 2'd2;
+// Each target below starts the request granted to it and acks the bus
+// that owns it when it completes
+
+wire sdram_go_dbus = dbus_go && dbus_target == T_SDRAM;
+wire sdram_go_ibus = ibus_go && ibus_target == T_SDRAM;
+wire psram_go_dbus = dbus_go && dbus_target == T_PSRAM;
+wire psram_go_ibus = ibus_go && ibus_target == T_PSRAM;
+wire wc_go = dbus_go && dbus_target == T_WC;
+
+// Ack a bus with read data (0 for writes) and end its access
+task complete;
+    input [1:0]  bus;
+    input [31:0] data;
+    begin
+        if (bus == BUS_DBUS) begin
+            dbus_ack <= 1;
+            dbus_dat_miso <= data;
+            dbus_busy <= 0;
+        end else begin
+            ibus_ack <= 1;
+            ibus_dat_miso <= data;
+            ibus_busy <= 0;
+        end
+    end
+endtask
 
 always @(posedge clk or posedge reset) begin
     if (reset) begin
@@ -322,179 +494,180 @@ always @(posedge clk or posedge reset) begin
         dbus_ack <= 0;
         ibus_dat_miso <= 0;
         dbus_dat_miso <= 0;
-        mem_pending <= 0;
-        pending_bus <= BUS_NONE;
-        ram_pending <= 0;
-        term_pending <= 0;
-        sdram_read_pending <= 0;
+        ibus_busy <= 0;
+        dbus_busy <= 0;
+        ram_bus <= BUS_NONE;
+        term_bus <= BUS_NONE;
+        psram_bus <= BUS_NONE;
+        sdram_read_ibus <= 0;
+        sdram_read_dbus <= 0;
         sdram_write_pending <= 0;
-        sdram_write_started <= 0;
         psram_read_pending <= 0;
         psram_write_pending <= 0;
         psram_write_started <= 0;
-        sysreg_pending <= 0;
         sdram_rd <= 0;
         sdram_wr <= 0;
         sdram_addr <= 0;
         sdram_wdata <= 0;
+        sdram_wstrb <= 0;
+        sdram_tag <= BUS_NONE;
         psram_rd <= 0;
         psram_wr <= 0;
         psram_addr <= 0;
         psram_wdata <= 0;
-        pending_rdata <= 0;
+        wc_dirty <= 0;
+        wc_flush <= 0;
+        wc_idx <= 0;
+        wc_idle <= 0;
+        for (wc_i = 0; wc_i < WC_WORDS; wc_i = wc_i + 1)
+            wc_mask[wc_i] <= 0;
     end else begin
         // Default: deassert ACKs and single-cycle signals
+        // SDRAM requests are held until accepted
         ibus_ack <= 0;
         dbus_ack <= 0;
-        sdram_rd <= 0;
-        sdram_wr <= 0;
+        if (sdram_ready) begin
+            sdram_rd <= 0;
+            sdram_wr <= 0;
+        end
         psram_rd <= 0;
         psram_wr <= 0;
 
-        if (!mem_pending && mem_valid) begin
-            // Start new memory access
-            pending_bus <= dbus_grant ? BUS_DBUS : BUS_IBUS;
+        // Unmapped region - return 0 immediately
+        if (dbus_go && dbus_target == T_NONE)
+            complete(BUS_DBUS, 32'h0);
+        if (ibus_go && ibus_target == T_NONE)
+            complete(BUS_IBUS, 32'h0);
+
+        // System registers
+        if (sysreg_go_dbus || sysreg_go_ibus)
+            complete(sysreg_go_dbus ? BUS_DBUS : BUS_IBUS, sysreg_rdata);
+
+        // BRAM: one access per cycle, data on the next
+        ram_bus <= ram_go_dbus ? BUS_DBUS : ram_go_ibus ? BUS_IBUS : BUS_NONE;
+        if (ram_go_dbus) dbus_busy <= 1;
+        if (ram_go_ibus) ibus_busy <= 1;
+        if (ram_bus != BUS_NONE)
+            complete(ram_bus, ram_rdata);
+
+        // Terminal
+        if (term_go_dbus || term_go_ibus) begin
+            term_bus <= term_go_dbus ? BUS_DBUS : BUS_IBUS;
+            if (term_go_dbus) dbus_busy <= 1;
+            else ibus_busy <= 1;
+        end else if (term_bus != BUS_NONE && term_mem_ready) begin
+            complete(term_bus, term_mem_rdata);
+            term_bus <= BUS_NONE;
+        end
 
-            if (ram_select) begin
-                mem_pending <= 1;
-                ram_pending <= 1;
-            end else if (sdram_select) begin
-                sdram_addr <= mem_addr[25:2];
-                if (mem_write) begin
-                    sdram_wr <= 1;
-                    sdram_wdata <= mem_wdata;
-                    mem_pending <= 1;
-                    sdram_write_pending <= 1;
-                    sdram_write_started <= 0;
-                end else begin
-                    sdram_rd <= 1;
-                    mem_pending <= 1;
-                    sdram_read_pending <= 1;
-                end
-            end else if (psram_select) begin
-                psram_addr <= mem_addr[23:2];  // 22-bit word address for 16MB
-                if (mem_write) begin
-                    psram_wr <= 1;
-                    psram_wdata <= mem_wdata;
-                    mem_pending <= 1;
-                    psram_write_pending <= 1;
-                    psram_write_started <= 0;
-                end else begin
-                    psram_rd <= 1;
-                    mem_pending <= 1;
-                    psram_read_pending <= 1;
-                end
-            end else if (term_select) begin
-                mem_pending <= 1;
-                term_pending <= 1;
-            end else if (sysreg_select) begin
-                mem_pending <= 1;
-                sysreg_pending <= 1;
+        // PSRAM
+        if (psram_go_dbus || psram_go_ibus) begin
+            psram_bus <= psram_go_dbus ? BUS_DBUS : BUS_IBUS;
+            if (psram_go_dbus) begin
+                dbus_busy <= 1;
+                psram_addr <= dbus_addr[23:2];  // 22-bit word address for 16MB
             end else begin
-                // Unknown region - return 0 immediately
-                if (dbus_grant) begin
-                    dbus_ack <= 1;
-                    dbus_dat_miso <= 32'h0;
-                end else begin
-                    ibus_ack <= 1;
-                    ibus_dat_miso <= 32'h0;
-                end
+                ibus_busy <= 1;
+                psram_addr <= ibus_addr[23:2];
             end
-        end else if (mem_pending) begin
-            // Complete pending access
-            if (ram_pending) begin
-                pending_rdata <= ram_rdata;
-                if (pending_bus == BUS_DBUS) begin
-                    dbus_ack <= 1;
-                    dbus_dat_miso <= ram_rdata;
-                end else begin
-                    ibus_ack <= 1;
-                    ibus_dat_miso <= ram_rdata;
-                end
-                mem_pending <= 0;
-                ram_pending <= 0;
-                pending_bus <= BUS_NONE;
-            end else if (sdram_read_pending && sdram_rdata_valid) begin
-                pending_rdata <= sdram_rdata;
-                if (pending_bus == BUS_DBUS) begin
-                    dbus_ack <= 1;
-                    dbus_dat_miso <= sdram_rdata;
-                end else begin
-                    ibus_ack <= 1;
-                    ibus_dat_miso <= sdram_rdata;
-                end
-                mem_pending <= 0;
-                sdram_read_pending <= 0;
-                pending_bus <= BUS_NONE;
-            end else if (sdram_write_pending) begin
-                // Write: wait for busy HIGH then LOW
-                if (!sdram_write_started && sdram_busy) begin
-                    sdram_write_started <= 1;
-                end else if (sdram_write_started && !sdram_busy) begin
-                    if (pending_bus == BUS_DBUS) begin
-                        dbus_ack <= 1;
-                        dbus_dat_miso <= 32'h0;
-                    end else begin
-                        ibus_ack <= 1;
-                        ibus_dat_miso <= 32'h0;
-                    end
-                    mem_pending <= 0;
-                    sdram_write_pending <= 0;
-                    sdram_write_started <= 0;
-                    pending_bus <= BUS_NONE;
-                end
-            end else if (psram_read_pending && psram_rdata_valid) begin
-                pending_rdata <= psram_rdata;
-                if (pending_bus == BUS_DBUS) begin
-                    dbus_ack <= 1;
-                    dbus_dat_miso <= psram_rdata;
-                end else begin
-                    ibus_ack <= 1;
-                    ibus_dat_miso <= psram_rdata;
-                end
-                mem_pending <= 0;
-                psram_read_pending <= 0;
-                pending_bus <= BUS_NONE;
-            end else if (psram_write_pending) begin
-                // Write: wait for busy HIGH then LOW
-                if (!psram_write_started && psram_busy) begin
-                    psram_write_started <= 1;
-                end else if (psram_write_started && !psram_busy) begin
-                    if (pending_bus == BUS_DBUS) begin
-                        dbus_ack <= 1;
-                        dbus_dat_miso <= 32'h0;
-                    end else begin
-                        ibus_ack <= 1;
-                        ibus_dat_miso <= 32'h0;
-                    end
-                    mem_pending <= 0;
-                    psram_write_pending <= 0;
-                    psram_write_started <= 0;
-                    pending_bus <= BUS_NONE;
-                end
-            end else if (term_pending && term_mem_ready) begin
-                if (pending_bus == BUS_DBUS) begin
-                    dbus_ack <= 1;
-                    dbus_dat_miso <= term_mem_rdata;
-                end else begin
-                    ibus_ack <= 1;
-                    ibus_dat_miso <= term_mem_rdata;
+            if (psram_go_dbus && dbus_we) begin
+                psram_wr <= 1;
+                psram_wdata <= dbus_dat_mosi;
+                psram_write_pending <= 1;
+                psram_write_started <= 0;
+            end else begin
+                psram_rd <= 1;
+                psram_read_pending <= 1;
+            end
+        end else if (psram_read_pending && psram_rdata_valid) begin
+            complete(psram_bus, psram_rdata);
+            psram_read_pending <= 0;
+            psram_bus <= BUS_NONE;
+        end else if (psram_write_pending) begin
+            // Write: wait for busy HIGH then LOW
+            if (!psram_write_started && psram_busy) begin
+                psram_write_started <= 1;
+            end else if (psram_write_started && !psram_busy) begin
+                complete(psram_bus, 32'h0);
+                psram_write_pending <= 0;
+                psram_write_started <= 0;
+                psram_bus <= BUS_NONE;
+            end
+        end
+
+        // SDRAM, either alias
+        if (sdram_go_dbus || sdram_go_ibus) begin
+            sdram_addr <= sdram_go_dbus ? dbus_addr[25:2] : ibus_addr[25:2];
+            sdram_tag <= sdram_go_dbus ? BUS_DBUS : BUS_IBUS;
+            if (sdram_go_dbus && dbus_we) begin
+                sdram_wr <= 1;
+                sdram_wdata <= dbus_dat_mosi;
+                sdram_wstrb <= dbus_wstrb;
+                sdram_write_pending <= 1;
+                dbus_busy <= 1;
+            end else begin
+                // Completes below when its tag comes back
+                sdram_rd <= 1;
+                if (sdram_go_dbus) sdram_read_dbus <= 1;
+                else sdram_read_ibus <= 1;
+            end
+        end
+        if (sdram_write_pending && sdram_ready) begin
+            // Write: complete once io_sdram has accepted it
+            complete(BUS_DBUS, 32'h0);
+            sdram_write_pending <= 0;
+        end
+
+        // SDRAM read data, routed by tag; the bus it belongs to has no
+        // other access in progress
+        if (sdram_rdata_valid) begin
+            if (sdram_rdata_tag == BUS_DBUS) begin
+                dbus_ack <= 1;
+                dbus_dat_miso <= sdram_rdata;
+                sdram_read_dbus <= 0;
+            end else begin
+                ibus_ack <= 1;
+                ibus_dat_miso <= sdram_rdata;
+                sdram_read_ibus <= 0;
+            end
+        end
+
+        // Write-combining buffer: merge a store (empty buffer or this block)
+        if (wc_go) begin
+            wc_block <= dbus_addr[25:5];
+            wc_dirty <= 1;
+            wc_idle <= 0;
+            for (wc_i = 0; wc_i < 4; wc_i = wc_i + 1) begin
+                if (dbus_wstrb[wc_i])
+                    wc_data[dbus_addr[4:2]][wc_i*8 +: 8] <= dbus_dat_mosi[wc_i*8 +: 8];
+            end
+            wc_mask[dbus_addr[4:2]] <= wc_mask[dbus_addr[4:2]] | dbus_wstrb;
+            complete(BUS_DBUS, 32'h0);
+        end else if (wc_dirty && wc_idle != WC_TIMEOUT) begin
+            wc_idle <= wc_idle + 1;
+        end
+
+        // ... and drain it, one word per free request slot (no SDRAM
+        // request is granted meanwhile)
+        if (wc_flush) begin
+            if (sdram_free) begin
+                if (|wc_mask[wc_idx]) begin
+                    sdram_wr <= 1;
+                    sdram_addr <= {wc_block, wc_idx};
+                    sdram_wdata <= wc_data[wc_idx];
+                    sdram_wstrb <= wc_mask[wc_idx];
+                    wc_mask[wc_idx] <= 0;
                 end
-                mem_pending <= 0;
-                term_pending <= 0;
-                pending_bus <= BUS_NONE;
-            end else if (sysreg_pending) begin
-                if (pending_bus == BUS_DBUS) begin
-                    dbus_ack <= 1;
-                    dbus_dat_miso <= sysreg_rdata;
-                end else begin
-                    ibus_ack <= 1;
-                    ibus_dat_miso <= sysreg_rdata;
+                wc_idx <= wc_idx + 1;
+                if (wc_idx == WC_WORDS - 1) begin
+                    wc_flush <= 0;
+                    wc_dirty <= 0;
                 end
-                mem_pending <= 0;
-                sysreg_pending <= 0;
-                pending_bus <= BUS_NONE;
             end
+        end else if (wc_dirty && (wc_idle == WC_TIMEOUT ||
+                                  (dbus_req && dbus_wc_stall) || (ibus_req && ibus_wc_stall))) begin
+            wc_flush <= 1;
+            wc_idx <= 0;
         end
     end
 end
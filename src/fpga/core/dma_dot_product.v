@@ -6,7 +6,7 @@
 // Registers:
 //   0x00: CTRL       - Write to start, read for status (bit 0 = busy, bit 4 = ready for next)
 //                      Write bits: [0]=start, [1]=use_cached_b, [2]=preload_b_only, [3]=pipeline_mode
-//                                  [4]=use_weight_cache, [5]=streaming_mode
+//                                  [4]=use_weight_cache, [5]=streaming_mode, [6]=q4_mode
 //   0x04: LENGTH     - Vector length in elements (up to 512)
 //   0x08: RESULT_LO  - Low 32 bits of accumulated result
 //   0x0C: RESULT_HI  - High 32 bits of accumulated result
@@ -26,6 +26,16 @@
 // Vectors are Q16.16 fixed-point (pre-converted by firmware)
 // Result is 64-bit to handle overflow from accumulation
 //
+// Q4 weights (CTRL bit 6): vector A is Q4_Q16 blocks (tools/convert_to_q4.py),
+// 5 words per 32 elements - a Q16.16 scale, then 4 words of 8 nibbles each
+// (element j in bits 4j+3:4j, stored offset by 8). Scales and packed words
+// land in the A buffers as fetched; the element path unpacks 2 nibbles per
+// cycle and multiplies by the block scale, so the MAC sees the same Q16.16
+// weight as (nibble - 8) * scale. LENGTH must be a multiple of 32. Applies
+// to the buffered and pipelined modes (prefetches use the same format);
+// bit 6 masks bits 4 and 5, so the weight cache and streaming modes
+// stay Q16.16. The dequantize multiply has its own pipeline stage.
+//
 
 `default_nettype none
 
@@ -69,6 +79,7 @@ reg preload_b_only;         // Only preload B, no computation
 reg pipeline_mode;          // Enable double-buffering pipeline
 reg [9:0] cached_b_length;  // Length of cached B vector
 reg streaming_mode;         // Streaming: compute as A arrives, no buffer
+reg q4_mode;                // A is Q4_Q16 blocks, dequantized on read
 
 // Double-buffer control
 reg active_buf;             // Which buffer is being used for compute (0 or 1)
@@ -99,6 +110,10 @@ reg signed [31:0] vec_a0 [0:MAX_LENGTH-1];
 reg signed [31:0] vec_a1 [0:MAX_LENGTH-1];
 reg signed [31:0] vec_b [0:MAX_LENGTH-1];
 
+// Q4 block scales, one per 32 elements of each A buffer
+reg signed [31:0] q4_scale0 [0:MAX_LENGTH/32-1];
+reg signed [31:0] q4_scale1 [0:MAX_LENGTH/32-1];
+
 // ==========================================================================
 // BRAM Weight Cache - 1 slot x 4096 elements = 16 KB
 // Caches one layer's output projection weights (64x64 = 4096 elements)
@@ -119,11 +134,24 @@ reg [11:0] cache_row_offset;        // Row offset within cache slot (for matmul)
 
 // Fetch counters
 reg [9:0] fetch_idx;
+reg [2:0] q4_phase;         // Word within Q4 block: 0 = scale, 1-4 = nibbles
+reg [3:0] q4_blk;           // Q4 block being fetched
+
+// A burst length in 16-bit words: 1 word per element, or 5 per Q4 block
+wire [6:0] q4_words = {vec_length[9:5], 2'b0} + {2'b0, vec_length[9:5]};
+wire [10:0] a_burst_len = q4_mode ? {3'b0, q4_words, 1'b0} : {vec_length, 1'b0};
 
 // Computation pipeline
 reg [9:0] comp_idx;
 
-// Pipeline registers for 2-way parallel multiply-accumulate
+// Pipeline registers for 2-way parallel multiply-accumulate. Stage 0
+// holds the pair as read (with the Q4 nibbles and scale), stage 1 the
+// dequantized operands, stage 2 the products.
+reg signed [31:0] w_a0, w_a1;
+reg signed [3:0]  w_nib0, w_nib1;
+reg signed [31:0] w_scale;
+reg signed [31:0] w_b0, w_b1;
+reg pipe0_valid;
 reg signed [31:0] op_a0, op_a1;
 reg signed [31:0] op_b0, op_b1;
 reg pipe1_valid;
@@ -133,6 +161,7 @@ reg pipe2_valid;
 // Streaming mode: B address index and registered B read
 reg [9:0] stream_idx;
 reg signed [31:0] stream_b_reg;
+reg stream_issued;          // Burst for this operation requested
 
 // Use burst_32bit for 32-bit transfers
 assign burst_32bit = 1'b1;
@@ -165,19 +194,87 @@ assign reg_rdata = rdata_comb;
 // Track if we've processed this access
 reg access_done;
 
-// 2-way parallel reads from active buffer
-wire signed [31:0] vec_a_read0 = active_buf ? vec_a1[comp_idx]   : vec_a0[comp_idx];
-wire signed [31:0] vec_a_read1 = active_buf ? vec_a1[comp_idx+1] : vec_a0[comp_idx+1];
+// 2-way parallel reads from active buffer (indexes are below MAX_LENGTH)
+wire [8:0] comp_idx0 = comp_idx[8:0];
+wire [8:0] comp_idx1 = comp_idx[8:0] + 9'd1;
+wire signed [31:0] vec_a_read0 = active_buf ? vec_a1[comp_idx0] : vec_a0[comp_idx0];
+wire signed [31:0] vec_a_read1 = active_buf ? vec_a1[comp_idx1] : vec_a0[comp_idx1];
 
 // Cache read - synchronous for M10K inference
-// Address is combinational (fast), data is registered (1-cycle latency)
-wire [11:0] cache_read_addr = cache_row_offset + {2'b0, comp_idx};
+// Address is combinational (fast), data is registered (1-cycle latency),
+// so while computing address the pair the next cycle consumes
+wire [9:0] cache_idx = (state == STATE_COMPUTE) ? comp_idx + 10'd2 : comp_idx;
+wire [11:0] cache_read_addr = cache_row_offset + {2'b0, cache_idx};
 reg signed [31:0] cache_read0_reg, cache_read1_reg;
 
-// Select weight source: cache or DMA buffer
+// Q4 unpack: comp_idx is even, so both elements come from one byte of
+// packed word comp_idx/8; XOR with 8 turns the stored q into signed q - 8
+wire [31:0] q4_word = active_buf ? vec_a1[{2'b0, comp_idx[9:3]}] : vec_a0[{2'b0, comp_idx[9:3]}];
+wire signed [31:0] q4_scale = active_buf ? q4_scale1[comp_idx[8:5]] : q4_scale0[comp_idx[8:5]];
+wire [7:0] q4_byte = q4_word[{comp_idx[2:1], 3'b0} +: 8];
+wire signed [3:0] q4_nib0 = q4_byte[3:0] ^ 4'h8;
+wire signed [3:0] q4_nib1 = q4_byte[7:4] ^ 4'h8;
+
+// Select weight source: cache or DMA buffer (Q4 is dequantized in stage 1)
 wire signed [31:0] weight_val0 = use_weight_cache ? cache_read0_reg : vec_a_read0;
 wire signed [31:0] weight_val1 = use_weight_cache ? cache_read1_reg : vec_a_read1;
 
+// Buffered-mode MAC front end: read a pair into stage 0, then
+// dequantize stage 0 into the multiplier operands. For an odd LENGTH the
+// second lane of the last pair is past the end and multiplies by zero.
+task mac_issue;
+    begin
+        if (comp_idx < vec_length) begin
+            w_a0 <= weight_val0; w_b0 <= vec_b[comp_idx0];
+            w_a1 <= weight_val1; w_b1 <= {1'b0, comp_idx1} < vec_length ? vec_b[comp_idx1] : 32'sd0;
+            w_nib0 <= q4_nib0; w_nib1 <= q4_nib1;
+            w_scale <= q4_scale;
+            pipe0_valid <= 1;
+            comp_idx <= comp_idx + 2;
+        end else begin
+            pipe0_valid <= 0;
+        end
+
+        if (pipe0_valid) begin
+            op_a0 <= q4_mode ? {{28{w_nib0[3]}}, w_nib0} * w_scale : w_a0; op_b0 <= w_b0;
+            op_a1 <= q4_mode ? {{28{w_nib1[3]}}, w_nib1} * w_scale : w_a1; op_b1 <= w_b1;
+            pipe1_valid <= 1;
+        end else begin
+            pipe1_valid <= 0;
+        end
+    end
+endtask
+
+// Store one burst word of A into a buffer: one element per word, or for
+// Q4 the block scale followed by 4 packed words
+task store_a_word(input buf_sel);
+    begin
+        if (q4_mode && q4_phase == 3'd0) begin
+            if (buf_sel)
+                q4_scale1[q4_blk] <= burst_data;
+            else
+                q4_scale0[q4_blk] <= burst_data;
+        end else if (q4_mode) begin
+            if (buf_sel)
+                vec_a1[{3'b0, q4_blk, q4_phase[1:0] - 2'd1}] <= burst_data;
+            else
+                vec_a0[{3'b0, q4_blk, q4_phase[1:0] - 2'd1}] <= burst_data;
+        end else begin
+            if (buf_sel)
+                vec_a1[fetch_idx[8:0]] <= burst_data;
+            else
+                vec_a0[fetch_idx[8:0]] <= burst_data;
+        end
+        fetch_idx <= fetch_idx + 1;
+        if (q4_phase == 3'd4) begin
+            q4_phase <= 0;
+            q4_blk <= q4_blk + 1;
+        end else begin
+            q4_phase <= q4_phase + 1;
+        end
+    end
+endtask
+
 // Main state machine
 always @(posedge clk or negedge reset_n) begin
     if (!reset_n) begin
@@ -200,10 +297,17 @@ always @(posedge clk or negedge reset_n) begin
         burst_addr <= 0;
         burst_len <= 0;
         fetch_idx <= 0;
+        q4_phase <= 0;
+        q4_blk <= 0;
         comp_idx <= 0;
         access_done <= 0;
+        pipe0_valid <= 0;
         pipe1_valid <= 0;
         pipe2_valid <= 0;
+        w_a0 <= 0; w_a1 <= 0;
+        w_b0 <= 0; w_b1 <= 0;
+        w_nib0 <= 0; w_nib1 <= 0;
+        w_scale <= 0;
         op_a0 <= 0; op_a1 <= 0;
         op_b0 <= 0; op_b1 <= 0;
         prod0 <= 0; prod1 <= 0;
@@ -222,6 +326,8 @@ always @(posedge clk or negedge reset_n) begin
         streaming_mode <= 0;
         stream_idx <= 0;
         stream_b_reg <= 0;
+        stream_issued <= 0;
+        q4_mode <= 0;
     end else begin
         // Default: deassert burst_rd after one cycle
         burst_rd <= 0;
@@ -229,10 +335,10 @@ always @(posedge clk or negedge reset_n) begin
         // Synchronous cache read (required for M10K block RAM inference)
         // Address is combinational, data is registered with 1-cycle latency
         cache_read0_reg <= weight_cache[cache_read_addr];
-        cache_read1_reg <= weight_cache[cache_read_addr + 1];
+        cache_read1_reg <= weight_cache[cache_read_addr + 12'd1];
 
         // Streaming mode: synchronous B vector read
-        stream_b_reg <= vec_b[stream_idx];
+        stream_b_reg <= vec_b[stream_idx[8:0]];
 
         // Clear access_done when valid goes low
         if (!reg_valid) begin
@@ -251,20 +357,25 @@ always @(posedge clk or negedge reset_n) begin
                         use_cached_b <= reg_wdata[1];
                         preload_b_only <= reg_wdata[2];
                         pipeline_mode <= reg_wdata[3];
-                        use_weight_cache <= reg_wdata[4];  // Bit 4: use BRAM weight cache
-                        streaming_mode <= reg_wdata[5];   // Bit 5: streaming compute mode
+                        use_weight_cache <= reg_wdata[4] && !reg_wdata[6];  // Bit 4: use BRAM weight cache
+                        streaming_mode <= reg_wdata[5] && !reg_wdata[6];    // Bit 5: streaming compute mode
+                        q4_mode <= reg_wdata[6];          // Bit 6: A is Q4 blocks
                         accumulator <= 0;
                         fetch_idx <= 0;
+                        q4_phase <= 0;
+                        q4_blk <= 0;
                         comp_idx <= 0;
+                        pipe0_valid <= 0;
                         pipe1_valid <= 0;
                         pipe2_valid <= 0;
                         stream_idx <= 0;
+                        stream_issued <= 0;
 
                         if (reg_wdata[2]) begin
                             // Preload B only
                             state <= STATE_FETCH_B;
                             cached_b_length <= vec_length;
-                        end else if (reg_wdata[4] && cache_slot_valid[0]) begin
+                        end else if (reg_wdata[4] && !reg_wdata[6] && cache_slot_valid[0]) begin
                             // Use weight cache - skip SDRAM A fetch
                             if (reg_wdata[1]) begin
                                 // Use cached B too - go to cache prime then compute
@@ -273,7 +384,7 @@ always @(posedge clk or negedge reset_n) begin
                                 // Need to fetch B first
                                 state <= STATE_FETCH_B;
                             end
-                        end else if (reg_wdata[5] && reg_wdata[1]) begin
+                        end else if (reg_wdata[5] && reg_wdata[1] && !reg_wdata[6]) begin
                             // Streaming mode with cached B - compute as A arrives
                             state <= STATE_STREAM_COMPUTE;
                         end else if (prefetch_done) begin
@@ -324,19 +435,17 @@ always @(posedge clk or negedge reset_n) begin
                 // Start burst read for vector A into active buffer
                 burst_rd <= 1;
                 burst_addr <= {addr_a, 1'b0};
-                burst_len <= {vec_length, 1'b0};
+                burst_len <= a_burst_len;
                 fetch_idx <= 0;
+                q4_phase <= 0;
+                q4_blk <= 0;
                 state <= STATE_WAIT_A;
             end
 
             STATE_WAIT_A: begin
                 // Store incoming data into active buffer
                 if (burst_data_valid) begin
-                    if (active_buf)
-                        vec_a1[fetch_idx] <= burst_data;
-                    else
-                        vec_a0[fetch_idx] <= burst_data;
-                    fetch_idx <= fetch_idx + 1;
+                    store_a_word(active_buf);
                 end
                 if (burst_data_done) begin
                     fetch_idx <= 0;
@@ -346,11 +455,13 @@ always @(posedge clk or negedge reset_n) begin
                             state <= STATE_COMPUTE_FETCH;
                             prefetch_pending <= 1;
                             comp_idx <= 0;
+                            pipe0_valid <= 0;
                             pipe1_valid <= 0;
                             pipe2_valid <= 0;
                         end else begin
                             state <= STATE_COMPUTE;
                             comp_idx <= 0;
+                            pipe0_valid <= 0;
                             pipe1_valid <= 0;
                             pipe2_valid <= 0;
                         end
@@ -370,7 +481,7 @@ always @(posedge clk or negedge reset_n) begin
 
             STATE_WAIT_B: begin
                 if (burst_data_valid) begin
-                    vec_b[fetch_idx] <= burst_data;
+                    vec_b[fetch_idx[8:0]] <= burst_data;
                     fetch_idx <= fetch_idx + 1;
                 end
                 if (burst_data_done) begin
@@ -380,11 +491,13 @@ always @(posedge clk or negedge reset_n) begin
                         // Go to cache prime to handle 1-cycle read latency
                         state <= STATE_CACHE_PRIME;
                         comp_idx <= 0;
+                        pipe0_valid <= 0;
                         pipe1_valid <= 0;
                         pipe2_valid <= 0;
                     end else begin
                         state <= STATE_COMPUTE;
                         comp_idx <= 0;
+                        pipe0_valid <= 0;
                         pipe1_valid <= 0;
                         pipe2_valid <= 0;
                     end
@@ -393,14 +506,7 @@ always @(posedge clk or negedge reset_n) begin
 
             STATE_COMPUTE: begin
                 // 2-way parallel computation from vec_a buffers or weight cache
-                if (comp_idx < vec_length) begin
-                    op_a0 <= weight_val0; op_b0 <= vec_b[comp_idx];
-                    op_a1 <= weight_val1; op_b1 <= vec_b[comp_idx+1];
-                    pipe1_valid <= 1;
-                    comp_idx <= comp_idx + 2;
-                end else begin
-                    pipe1_valid <= 0;
-                end
+                mac_issue;
 
                 if (pipe1_valid) begin
                     // 2 parallel multiplies
@@ -417,7 +523,7 @@ always @(posedge clk or negedge reset_n) begin
                 end
 
                 // Done when all elements processed
-                if (comp_idx >= vec_length && !pipe1_valid && !pipe2_valid) begin
+                if (comp_idx >= vec_length && !pipe0_valid && !pipe1_valid && !pipe2_valid) begin
                     state <= STATE_DONE;
                 end
             end
@@ -425,16 +531,8 @@ always @(posedge clk or negedge reset_n) begin
             STATE_COMPUTE_FETCH: begin
                 // Concurrent 2-way parallel compute + prefetch into other buffer
 
-                // 2-way parallel computation pipeline
-                if (comp_idx < vec_length) begin
-                    // Read 2 elements in parallel from weight cache or active buffer
-                    op_a0 <= weight_val0; op_b0 <= vec_b[comp_idx];
-                    op_a1 <= weight_val1; op_b1 <= vec_b[comp_idx+1];
-                    pipe1_valid <= 1;
-                    comp_idx <= comp_idx + 2;  // Process 2 elements per cycle
-                end else begin
-                    pipe1_valid <= 0;
-                end
+                // 2-way parallel computation pipeline, 2 elements per cycle
+                mac_issue;
 
                 if (pipe1_valid) begin
                     // 2 parallel multiplies
@@ -454,16 +552,14 @@ always @(posedge clk or negedge reset_n) begin
                 if (prefetch_pending && !burst_rd && fetch_idx == 0) begin
                     burst_rd <= 1;
                     burst_addr <= {addr_a_next, 1'b0};
-                    burst_len <= {vec_length, 1'b0};
+                    burst_len <= a_burst_len;
+                    q4_phase <= 0;
+                    q4_blk <= 0;
                 end
 
                 // Store prefetch data into OTHER buffer
                 if (burst_data_valid) begin
-                    if (active_buf)
-                        vec_a0[fetch_idx] <= burst_data;  // Active=1, prefetch to 0
-                    else
-                        vec_a1[fetch_idx] <= burst_data;  // Active=0, prefetch to 1
-                    fetch_idx <= fetch_idx + 1;
+                    store_a_word(~active_buf);  // Active=1, prefetch to 0 and vice versa
                 end
 
                 if (burst_data_done) begin
@@ -473,7 +569,7 @@ always @(posedge clk or negedge reset_n) begin
                 end
 
                 // Check if compute is done
-                if (comp_idx >= vec_length && !pipe1_valid && !pipe2_valid) begin
+                if (comp_idx >= vec_length && !pipe0_valid && !pipe1_valid && !pipe2_valid) begin
                     if (prefetch_pending) begin
                         // Compute done but prefetch still going
                         state <= STATE_WAIT_PREFETCH;
@@ -486,11 +582,7 @@ always @(posedge clk or negedge reset_n) begin
             STATE_WAIT_PREFETCH: begin
                 // Compute finished, waiting for prefetch to complete
                 if (burst_data_valid) begin
-                    if (active_buf)
-                        vec_a0[fetch_idx] <= burst_data;
-                    else
-                        vec_a1[fetch_idx] <= burst_data;
-                    fetch_idx <= fetch_idx + 1;
+                    store_a_word(~active_buf);
                 end
 
                 if (burst_data_done) begin
@@ -512,6 +604,7 @@ always @(posedge clk or negedge reset_n) begin
                 // Transition to compute - first compute cycle will use correct data
                 state <= STATE_COMPUTE;
                 comp_idx <= 0;
+                pipe0_valid <= 0;
                 pipe1_valid <= 0;
                 pipe2_valid <= 0;
             end
@@ -545,8 +638,10 @@ always @(posedge clk or negedge reset_n) begin
             // ==========================================================================
 
             STATE_STREAM_COMPUTE: begin
-                // Start burst read on first cycle
-                if (!burst_rd && stream_idx == 0 && !pipe1_valid) begin
+                // Start burst read on first cycle (once - data takes several
+                // cycles to arrive and io_sdram would queue a second burst)
+                if (!stream_issued) begin
+                    stream_issued <= 1;
                     burst_rd <= 1;
                     burst_addr <= {addr_a, 1'b0};
                     burst_len <= {vec_length, 1'b0};
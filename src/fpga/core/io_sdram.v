@@ -4,7 +4,9 @@
 // 2019-2022 Analogue
 //
 
-module io_sdram (
+module io_sdram #(
+    parameter ADDR_MAP = 0          // ADDR_MAP_* below
+) (
 
 input   wire            controller_clk,
 input   wire            chip_clk,
@@ -42,13 +44,29 @@ input   wire    [23:0]  word_addr,
 input   wire    [31:0]  word_data,
 output  reg     [31:0]  word_q,
 output  reg             word_busy,
-output  reg             word_q_valid  // Pulses high for one cycle when word_q data is valid
+output  reg             word_q_valid,  // Pulses high for one cycle when word_q data is valid
+
+input   wire            sync_word_valid, // must be synchronous to controller_clk
+input   wire            sync_word_wr,    // 1=write, 0=read
+input   wire    [23:0]  sync_word_addr,
+input   wire    [31:0]  sync_word_data,
+input   wire    [1:0]   sync_word_tag,   // returned with the read data
+input   wire    [3:0]   sync_word_mask,  // byte enables of a write, [3] = data[31:24]
+output  wire            sync_word_ready, // request accepted on valid & ready
+output  reg             sync_word_q_valid, // read data is in word_q
+output  reg     [1:0]   sync_word_q_tag, // ... for the request with this tag
+
+output  wire            refresh_urgent,  // refresh debt or gap at its limit, refresh goes first (observed by sim only)
+
+input   wire            stat_snapshot,   // copy the counters to stats, and ...
+input   wire            stat_clear,      // ... (same cycle) restart them from zero
+output  reg     [415:0] stats            // STAT_* counters, 32 bits each, as of the last snapshot
 );
 
     // tristate for DQ
     reg             phy_dq_oe;      
-    assign          phy_dq = phy_dq_oe ? phy_dq_out : 16'bZZZZZZZZZZZZZZZZ;
     reg     [15:0]  phy_dq_out;
+    assign          phy_dq = phy_dq_oe ? phy_dq_out : 16'bZZZZZZZZZZZZZZZZ;
 
     reg     [2:0]   cmd;
 assign {phy_ras, phy_cas, phy_we} = cmd;
@@ -63,6 +81,33 @@ assign {phy_ras, phy_cas, phy_we} = cmd;
     localparam      CMD_SELFENTER       = 3'b001;
     localparam      CMD_SELFEXIT        = 3'b111;
 
+    // Address mapping. addr is the linear 16-bit-word address and only
+    // ever increments; bank and row are derived from it at each ACT. The
+    // column is addr[9:0] in every mapping, so a row is always 1024
+    // consecutive words and the end-of-row checks are unchanged.
+    //   ADDR_MAP_LINEAR    bank:row:col - each 16MB quarter is one bank
+    //   ADDR_MAP_ROW_BANK  row:bank:col - consecutive 2KB rows rotate banks
+    //   ADDR_MAP_XOR       row:bank:col with the bank XORed with a fold of
+    //                      the row, so regions a power of two apart (the
+    //                      framebuffers, weights, KV cache) start in
+    //                      different banks
+    localparam      ADDR_MAP_LINEAR     = 0;
+    localparam      ADDR_MAP_ROW_BANK   = 1;
+    localparam      ADDR_MAP_XOR        = 2;
+
+function [1:0] map_bank(input [24:0] a);
+    case (ADDR_MAP)
+    ADDR_MAP_ROW_BANK:  map_bank = a[11:10];
+    ADDR_MAP_XOR:       map_bank = a[11:10] ^ a[13:12] ^ a[15:14] ^ a[17:16] ^
+                                   a[19:18] ^ a[21:20] ^ a[23:22] ^ {1'b0, a[24]};
+    default:            map_bank = a[24:23];
+    endcase
+endfunction
+
+function [12:0] map_row(input [24:0] a);
+    map_row = ADDR_MAP == ADDR_MAP_LINEAR ? a[22:10] : a[24:12];
+endfunction
+
     localparam      CAS                 =   4'd3;   // timings are for 166mhz
     localparam      TIMING_LMR          =   4'd2;   // tLMR = 2ck
     localparam      TIMING_AUTOREFRESH  =   4'd12;  // tRFC = 80
@@ -118,7 +163,6 @@ assign {phy_ras, phy_cas, phy_we} = cmd;
     reg     [23:0]  delay_boot;
     reg     [15:0]  dc;
     reg     [9:0]   refresh_count;
-    reg             issue_autorefresh;
     
     wire reset_n_s;
 synch_3 s1(reset_n, reset_n_s, controller_clk);
@@ -140,17 +184,116 @@ synch_3 s3(word_wr, word_wr_s, controller_clk, word_wr_r);
     // The sender must hold these stable until the operation completes
     reg [23:0] word_addr_captured;
     reg [31:0] word_data_captured;
+    reg [31:0] word_wdata;  // data of the word write in progress
+    reg [3:0]  word_mask;   // ... and its byte enables (DQM is their inverse)
+
+    // Same-clock word requests: no synchronizer. A request presented while
+    // the FSM is idle starts on the next edge; otherwise it waits in a
+    // SYNC_QUEUE_DEPTH-entry queue (ready is low while it is full). Writes
+    // are complete as far as the requester is concerned once accepted.
+    // Requests start oldest first, but when a read finishes, a queued read
+    // to the same row with no older write ahead of it is chained under the
+    // same ACT. Read data can therefore come back out of order, so each
+    // request carries a tag that is returned with its data. Likewise a
+    // write is followed straight away by the next request if that is a
+    // write to the same row, so sequential stores go out as a burst.
+    localparam      SYNC_QUEUE_DEPTH    = 4;
+
+    reg             sq_wr   [0:SYNC_QUEUE_DEPTH-1];
+    reg     [23:0]  sq_addr [0:SYNC_QUEUE_DEPTH-1];
+    reg     [31:0]  sq_data [0:SYNC_QUEUE_DEPTH-1];
+    reg     [1:0]   sq_tag  [0:SYNC_QUEUE_DEPTH-1];
+    reg     [3:0]   sq_mask [0:SYNC_QUEUE_DEPTH-1];
+    reg     [2:0]   sq_count;
+    wire    [1:0]   sq_last = sq_count[1:0] - 2'd1;
+    wire            sync_word_pending = sq_count != 0 || sync_word_valid;
+    wire            sync_word_pending_wr = sq_count != 0 ? sq_wr[0] : sync_word_wr;
+    wire    [23:0]  sync_word_pending_addr = sq_count != 0 ? sq_addr[0] : sync_word_addr;
+    wire    [31:0]  sync_word_pending_data = sq_count != 0 ? sq_data[0] : sync_word_data;
+    wire    [1:0]   sync_word_pending_tag = sq_count != 0 ? sq_tag[0] : sync_word_tag;
+    wire    [3:0]   sync_word_pending_mask = sq_count != 0 ? sq_mask[0] : sync_word_mask;
+assign sync_word_ready = sq_count != SYNC_QUEUE_DEPTH;
+
+    // Oldest queued read in the open row with no write queued ahead of it
+    reg     [12:0]  open_row;
+    reg             sq_chain_hit;
+    reg     [1:0]   sq_chain_idx;
+    reg             sq_older_write;
+    integer         sq_j;
+always @(*) begin
+    sq_chain_hit = 0;
+    sq_chain_idx = 0;
+    sq_older_write = 0;
+    for (sq_j = 0; sq_j < SYNC_QUEUE_DEPTH; sq_j = sq_j + 1) begin
+        if (sq_j[2:0] < sq_count && !sq_chain_hit) begin
+            if (sq_wr[sq_j])
+                sq_older_write = 1;
+            else if (!sq_older_write && map_bank({sq_addr[sq_j], 1'b0}) == phy_ba &&
+                     map_row({sq_addr[sq_j], 1'b0}) == open_row) begin
+                sq_chain_hit = 1;
+                sq_chain_idx = sq_j[1:0];
+            end
+        end
+    end
+end
 
     reg burst_rd_queue;
     reg burstwr_queue;
+
+    // Refresh scheduling, JEDEC postponement and pull-in. refresh_debt is
+    // the number of refreshes owed: +1 every 1024 clocks (7.7us, inside
+    // tREFI), -1 per REF. While it is positive a refresh waits until the
+    // FSM is idle with nothing queued, so it does not split streams or
+    // delay scanout. At REFRESH_MAX_DEBT refresh_urgent rises and the
+    // refresh goes ahead of every request (and ends a burst write at the
+    // next row). After REFRESH_IDLE_CYCLES quiet clocks up to
+    // REFRESH_MAX_AHEAD refreshes are pulled in early.
+    // Pulling in 8 and then postponing 8 would leave 16 intervals between
+    // two REFs, but JEDEC allows at most 9 tREFI. refresh_gap counts clocks
+    // since the last REF and makes the refresh urgent after
+    // REFRESH_MAX_GAP, leaving a burst write to the end of its row time to
+    // finish inside 9 tREFI (9351 clocks).
+    localparam      REFRESH_MAX_DEBT    = 8;
+    localparam      REFRESH_MAX_AHEAD   = 8;
+    localparam      REFRESH_IDLE_CYCLES = 16;
+    localparam      REFRESH_MAX_GAP     = 8 * 1024;
+
+    reg signed [4:0] refresh_debt;
+    reg     [4:0]   refresh_idle;   // quiet clocks in ST_IDLE, saturating
+    reg     [13:0]  refresh_gap;    // clocks since the last REF, saturating
+    wire            any_request = word_rd_queue | word_wr_queue | sync_word_pending |
+                                  burst_rd_queue | burstwr_queue | burst_rd | burstwr;
+assign refresh_urgent = refresh_debt >= REFRESH_MAX_DEBT || refresh_gap >= REFRESH_MAX_GAP;
+    wire            refresh_start = refresh_urgent ||
+                                    (!any_request && (refresh_debt > 0 ||
+                                     (refresh_idle == REFRESH_IDLE_CYCLES &&
+                                      refresh_debt > -REFRESH_MAX_AHEAD)));
+    wire            sync_word_start = state == ST_IDLE && !refresh_start &&
+                                      !word_rd_queue && !word_wr_queue && sync_word_pending;
     
     reg             word_op;
+    reg             word_op_sync;   // word_op came from the sync_word port
+    reg     [1:0]   word_tag;       // sync_word tag of the read being issued
+    reg     [1:0]   dq_tag, dq_tag_1, dq_tag_2, dq_tag_3, dq_tag_4;
+    integer         sq_i;
     reg             bram_op;
     reg     [24:0]  addr;
     wire    [9:0]   addr_col9_next_1 = addr[9:0] + 'h1;
     
     reg     [10:0]  length;
     wire    [10:0]  length_next = length - 'h1;
+    // Oldest queued read in the open row; like the write chain below it
+    // gives way to the other ports
+    wire            sync_word_chain = state == ST_READ_2 && word_op_sync && length == 1 &&
+                                      !refresh_urgent && !word_rd_queue && !word_wr_queue &&
+                                      !burst_rd_queue && sq_chain_hit;
+    // Next write in the row of the one finishing; gives way to the other ports
+    wire            sync_word_wchain = state == ST_WRITE_3 && word_op_sync && !refresh_urgent &&
+                                       !word_rd_queue && !word_wr_queue && !burst_rd_queue &&
+                                       sync_word_pending && sync_word_pending_wr &&
+                                       map_bank({sync_word_pending_addr, 1'b0}) == phy_ba &&
+                                       map_row({sync_word_pending_addr, 1'b0}) == open_row;
+    wire            sync_word_take = sync_word_start || sync_word_wchain;
     reg             enable_dq_read, enable_dq_read_1, enable_dq_read_2, enable_dq_read_3, enable_dq_read_4, enable_dq_read_5;
     reg             enable_dq_read_toggle;
     
@@ -168,11 +311,11 @@ end
 
     
 always @(*) begin
-    burst_data_done <= enable_data_done_4;
+    burst_data_done = enable_data_done_4;
 end
 initial begin
-    state <= ST_RESET;
-    phy_cke <= 0;
+    state = ST_RESET;
+    phy_cke = 0;
 end
 always @(posedge controller_clk) begin
     phy_dq_oe <= 0;
@@ -182,6 +325,7 @@ always @(posedge controller_clk) begin
     burst_data_valid <= 0;
     burstwr_ready <= 0;
     word_q_valid <= 0;  // Clear each cycle, set when read data is captured
+    sync_word_q_valid <= 0;
     
     enable_dq_read_5 <= enable_dq_read_4;
     enable_dq_read_4 <= enable_dq_read_3;
@@ -189,6 +333,10 @@ always @(posedge controller_clk) begin
     enable_dq_read_2 <= enable_dq_read_1;
     enable_dq_read_1 <= enable_dq_read;
     enable_dq_read <= 0;
+    dq_tag_4 <= dq_tag_3;
+    dq_tag_3 <= dq_tag_2;
+    dq_tag_2 <= dq_tag_1;
+    dq_tag_1 <= dq_tag;
     
     enable_data_done_4 <= enable_data_done_3;
     enable_data_done_3 <= enable_data_done_2;
@@ -209,7 +357,11 @@ always @(posedge controller_clk) begin
             end else begin
                 // odd cycles - low half captured, word is now complete
                 word_q[15:0] <= phy_dq;
-                word_q_valid <= 1;  // Signal that word_q is valid
+                if(word_op_sync) begin
+                    sync_word_q_valid <= 1;
+                    sync_word_q_tag <= dq_tag_4;
+                end else
+                    word_q_valid <= 1;  // Signal that word_q is valid
             end
         
         end else begin
@@ -237,9 +389,9 @@ always @(posedge controller_clk) begin
         phy_cke <= 0;
         cmd <= CMD_NOP;
         delay_boot <= 0;
-        issue_autorefresh <= 0;
         phy_dqm <= 2'b00;
         read_cmd_issued <= 0;
+        sq_count <= 0;
 
         state <= ST_BOOT_0;
     end
@@ -253,7 +405,7 @@ always @(posedge controller_clk) begin
             
             // precharge all
             cmd <= CMD_PRECHG;
-            phy_a[10] = 1'b1;
+            phy_a[10] <= 1'b1;
     
             state <= ST_BOOT_1;
         end
@@ -308,15 +460,16 @@ always @(posedge controller_clk) begin
         read_newrow <= 0;
         word_busy <= 0;
         word_op <= 0;
+        word_op_sync <= 0;
 
-        if(issue_autorefresh) begin
+        if(refresh_start) begin
             state <= ST_REFRESH_0;
             word_busy <= 1;  // Busy during refresh
         end else
         if(word_rd_queue) begin
             word_rd_queue <= 0;
             word_op <= 1;
-            addr <= word_addr_captured << 1;  // Use captured address
+            addr <= {word_addr_captured, 1'b0};  // Use captured address
             word_busy <= 1;  // Busy during word read
 
             length <= 2;
@@ -325,11 +478,25 @@ always @(posedge controller_clk) begin
         if(word_wr_queue) begin
             word_wr_queue <= 0;
             word_op <= 1;
-            addr <= word_addr_captured << 1;  // Use captured address
+            addr <= {word_addr_captured, 1'b0};  // Use captured address
+            word_wdata <= word_data_captured;
+            word_mask <= 4'b1111;
             word_busy <= 1;  // Busy during word write
 
             state <= ST_WRITE_0;
         end else
+        if(sync_word_start) begin
+            word_op <= 1;
+            word_op_sync <= 1;
+            addr <= {sync_word_pending_addr, 1'b0};
+            word_wdata <= sync_word_pending_data;
+            word_mask <= sync_word_pending_mask;
+            word_tag <= sync_word_pending_tag;
+            word_busy <= 1;
+
+            length <= 2;
+            state <= sync_word_pending_wr ? ST_WRITE_0 : ST_READ_0;
+        end else
         if(burst_rd_queue) begin
             burst_rd_queue <= 0;
             addr <= burst_addr;
@@ -352,8 +519,9 @@ always @(posedge controller_clk) begin
     ST_WRITE_0: begin
         dc <= 0;
         
-        phy_ba <= addr[24:23];
-        phy_a <= addr[22:10]; // A0-A12 column address
+        phy_ba <= map_bank(addr);
+        phy_a <= map_row(addr); // A0-A12 row address
+        open_row <= map_row(addr);
         cmd <= CMD_ACT;
         
         state <= ST_WRITE_1;
@@ -369,10 +537,11 @@ always @(posedge controller_clk) begin
     ST_WRITE_2: begin
         dc <= 0;
 
-        phy_a <= addr[9:0]; // A0-A9 row address
+        phy_a <= {3'b0, addr[9:0]}; // A0-A9 row address
         cmd <= CMD_WRITE;
         phy_dq_oe <= 1;
-        phy_dq_out <= word_data_captured[31:16];  // Use captured data
+        phy_dq_out <= word_wdata[31:16];
+        phy_dqm <= ~word_mask[3:2];
         addr <= addr + 1'b1;
 
         state <= ST_WRITE_3;
@@ -380,15 +549,24 @@ always @(posedge controller_clk) begin
     ST_WRITE_3: begin
         dc <= 0;
 
-        phy_a <= addr[9:0]; // A0-A9 row address
+        phy_a <= {3'b0, addr[9:0]}; // A0-A9 row address
         cmd <= CMD_WRITE;
         phy_dq_oe <= 1;
-        phy_dq_out <= word_data_captured[15:0];  // Use captured data
+        phy_dq_out <= word_wdata[15:0];
+        phy_dqm <= ~word_mask[1:0];
         addr <= addr + 1'b1;
 
-        state <= ST_WRITE_4;
+        if(sync_word_wchain) begin
+            // queued write in the same row: issue it without a new ACT
+            addr <= {sync_word_pending_addr, 1'b0};
+            word_wdata <= sync_word_pending_data;
+            word_mask <= sync_word_pending_mask;
+            state <= ST_WRITE_2;
+        end else
+            state <= ST_WRITE_4;
     end
     ST_WRITE_4: begin
+        phy_dqm <= 2'b00;
         if(dc == TIMING_WRITE-1+1) begin
             dc <= 0;
             cmd <= CMD_PRECHG;
@@ -406,8 +584,9 @@ always @(posedge controller_clk) begin
     ST_READ_0: begin
         dc <= 0;
         
-        phy_ba <= addr[24:23];
-        phy_a <= addr[22:10]; // A0-A12 column address
+        phy_ba <= map_bank(addr);
+        phy_a <= map_row(addr); // A0-A12 row address
+        open_row <= map_row(addr);
         cmd <= CMD_ACT;
         
         state <= ST_READ_1;
@@ -421,14 +600,21 @@ always @(posedge controller_clk) begin
         end
     end
     ST_READ_2: begin
-        phy_a <= addr[9:0]; // A0-A9 row address
+        phy_a <= {3'b0, addr[9:0]}; // A0-A9 row address
         cmd <= CMD_READ;
 
         enable_dq_read <= 1;
+        dq_tag <= word_tag;
 
         length <= length - 1'b1;
         addr <= addr + 1'b1;
 
+        if(sync_word_chain) begin
+            // queued read in the same row: issue it without a new ACT
+            addr <= {sq_addr[sq_chain_idx], 1'b0};
+            word_tag <= sq_tag[sq_chain_idx];
+            length <= 2;
+        end else
         if(length == 1) begin
             // we just read the last word, bail
             read_newrow <= 0;
@@ -466,8 +652,10 @@ always @(posedge controller_clk) begin
     end
     
     ST_BURSTWR_0: begin
-        phy_ba <= addr[24:23];
-        phy_a <= addr[22:10]; // A0-A12 column address
+        dc <= 0;
+
+        phy_ba <= map_bank(addr);
+        phy_a <= map_row(addr); // A0-A12 row address
         cmd <= CMD_ACT;
         state <= ST_BURSTWR_1;
     end
@@ -485,7 +673,7 @@ always @(posedge controller_clk) begin
         
         if(burstwr_strobe) begin
         
-            phy_a <= addr[9:0]; // A0-A9 row address
+            phy_a <= {3'b0, addr[9:0]}; // A0-A9 row address
             cmd <= CMD_WRITE;
             phy_dq_oe <= 1;
             phy_dq_out <= burstwr_data;
@@ -507,9 +695,13 @@ always @(posedge controller_clk) begin
         state <= ST_BURSTWR_5;
     end
     ST_BURSTWR_5: begin
-        cmd <= CMD_PRECHG;
-        phy_a[10] <= 0; // only precharge current bank 
-        state <= ST_BURSTWR_6;
+        // a single-beat burst gets here 4 clocks after the ACT; hold the
+        // PRECHARGE until the row has been open for tRAS
+        if(dc >= TIMING_ACT_PRECHG-1) begin
+            cmd <= CMD_PRECHG;
+            phy_a[10] <= 0; // only precharge current bank 
+            state <= ST_BURSTWR_6;
+        end
     end
     ST_BURSTWR_6: begin
         cmd <= CMD_NOP;
@@ -520,7 +712,7 @@ always @(posedge controller_clk) begin
         state <= ST_IDLE;   
         if(burstwr_newrow) begin
             state <= ST_BURSTWR_0;
-            if(issue_autorefresh) begin
+            if(refresh_urgent) begin
                 state <= ST_REFRESH_0;
             end
         end
@@ -529,8 +721,6 @@ always @(posedge controller_clk) begin
     
     ST_REFRESH_0: begin
         // autorefresh 
-        issue_autorefresh <= 0;
-        
         cmd <= CMD_AUTOREF;
         dc <= 0;
         state <= ST_REFRESH_1;
@@ -559,6 +749,36 @@ always @(posedge controller_clk) begin
         word_addr_captured <= word_addr;  // Capture address on rising edge
         word_data_captured <= word_data;  // Capture data on rising edge
     end
+    // sync_word queue: remove the entry started or chained (entries behind
+    // it move up), append a request accepted while it could not start
+    if((sync_word_take && sq_count != 0) || sync_word_chain) begin
+        for(sq_i = 0; sq_i < SYNC_QUEUE_DEPTH - 1; sq_i = sq_i + 1) begin
+            if(sq_i[1:0] >= (sync_word_chain ? sq_chain_idx : 2'd0)) begin
+                sq_wr[sq_i] <= sq_wr[sq_i + 1];
+                sq_addr[sq_i] <= sq_addr[sq_i + 1];
+                sq_data[sq_i] <= sq_data[sq_i + 1];
+                sq_tag[sq_i] <= sq_tag[sq_i + 1];
+                sq_mask[sq_i] <= sq_mask[sq_i + 1];
+            end
+        end
+        if(sync_word_valid && sync_word_ready) begin
+            sq_wr[sq_last] <= sync_word_wr;
+            sq_addr[sq_last] <= sync_word_addr;
+            sq_data[sq_last] <= sync_word_data;
+            sq_tag[sq_last] <= sync_word_tag;
+            sq_mask[sq_last] <= sync_word_mask;
+        end else begin
+            sq_count <= sq_count - 1'b1;
+        end
+    end else
+    if(sync_word_valid && sync_word_ready && !sync_word_take) begin
+        sq_wr[sq_count[1:0]] <= sync_word_wr;
+        sq_addr[sq_count[1:0]] <= sync_word_addr;
+        sq_data[sq_count[1:0]] <= sync_word_data;
+        sq_tag[sq_count[1:0]] <= sync_word_tag;
+        sq_mask[sq_count[1:0]] <= sync_word_mask;
+        sq_count <= sq_count + 1'b1;
+    end
     if(burst_rd) begin
         burst_rd_queue <= 1;
     end
@@ -566,21 +786,102 @@ always @(posedge controller_clk) begin
         burstwr_queue <= 1;
     end
     
-    // autorefresh generator
+    // autorefresh debt: one more owed every 1024 clocks (7.7us @ 133mhz),
+    // one paid per REF. The boot sequence refreshes on its own.
+    // note that the number of rows affects how often you must issue a refresh command
+    // and this particular sdram has more than usual
     refresh_count <= refresh_count + 1'b1;
-    if(&refresh_count) begin 
-        // every 6.144 uS @ 166mhz
-        // note that the number of rows affects how often you must issue a refresh command
-        // and this particular sdram has more than usual
-        refresh_count <= 0;
-        issue_autorefresh <= 1;
-    
+    if(state < ST_IDLE) begin
+        refresh_debt <= 0;
+    end else begin
+        refresh_debt <= refresh_debt + ((&refresh_count && refresh_debt != 5'sd15) ? 5'sd1 : 5'sd0)
+                                     - (state == ST_REFRESH_0 ? 5'sd1 : 5'sd0);
+    end
+    if(state == ST_IDLE && !any_request && !refresh_start) begin
+        if(refresh_idle != REFRESH_IDLE_CYCLES) refresh_idle <= refresh_idle + 1'b1;
+    end else begin
+        refresh_idle <= 0;
+    end
+    if(state < ST_IDLE || state == ST_REFRESH_0) begin
+        refresh_gap <= 0;
+    end else if(!(&refresh_gap)) begin
+        refresh_gap <= refresh_gap + 1'b1;
     end
     
     if(~reset_n_s) begin    
         // reset
         state <= ST_RESET;
         refresh_count <= 0;
+        refresh_idle <= 0;
+        refresh_gap <= 0;
+        sq_count <= 0;
+    end
+end
+
+    // Statistics: what the controller spends its cycles on. Row hits and
+    // misses count requests, not column commands: a hit is a CPU request
+    // chained into the row the previous one left open, a miss is an ACT
+    // issued for a CPU request. Video, bridge and burst-write ACTs only
+    // show up in STAT_ACT.
+    // (sdram_checker's row-hit rate is per column command instead.) Port
+    // waits are cycles a request is queued but not started. Video fetch
+    // latency runs from burst_rd to the first burst_data_valid.
+    localparam      STAT_CYCLES         = 0;
+    localparam      STAT_ACT            = 1;
+    localparam      STAT_READ_BEATS     = 2;
+    localparam      STAT_WRITE_BEATS    = 3;
+    localparam      STAT_ROW_HITS       = 4;
+    localparam      STAT_ROW_MISSES     = 5;
+    localparam      STAT_REFRESH        = 6;
+    localparam      STAT_IDLE           = 7;
+    localparam      STAT_WAIT_CPU       = 8;    // sync_word port
+    localparam      STAT_WAIT_BRIDGE    = 9;    // word port
+    localparam      STAT_WAIT_VIDEO     = 10;   // burst_rd port
+    localparam      STAT_WAIT_BURSTWR   = 11;
+    localparam      STAT_VIDEO_MAX_LAT  = 12;
+    localparam      STAT_COUNT          = 13;
+
+    reg     [31:0]  stat_cnt [0:STAT_COUNT-1];
+    reg             stat_video_run;
+    reg     [31:0]  stat_video_lat;
+    integer         stat_i;
+
+always @(posedge controller_clk) begin
+    if(stat_snapshot) begin
+        for(stat_i = 0; stat_i < STAT_COUNT; stat_i = stat_i + 1)
+            stats[stat_i*32 +: 32] <= stat_cnt[stat_i];
+    end
+
+    stat_cnt[STAT_CYCLES] <= stat_cnt[STAT_CYCLES] + 1'b1;
+    stat_cnt[STAT_ACT] <= stat_cnt[STAT_ACT] + {31'b0, cmd == CMD_ACT};
+    stat_cnt[STAT_READ_BEATS] <= stat_cnt[STAT_READ_BEATS] + {31'b0, cmd == CMD_READ};
+    stat_cnt[STAT_WRITE_BEATS] <= stat_cnt[STAT_WRITE_BEATS] + {31'b0, cmd == CMD_WRITE};
+    stat_cnt[STAT_ROW_HITS] <= stat_cnt[STAT_ROW_HITS] + {31'b0, sync_word_chain | sync_word_wchain};
+    stat_cnt[STAT_ROW_MISSES] <= stat_cnt[STAT_ROW_MISSES] + {31'b0, cmd == CMD_ACT && word_op_sync};
+    stat_cnt[STAT_REFRESH] <= stat_cnt[STAT_REFRESH] +
+                              {31'b0, state == ST_REFRESH_0 || state == ST_REFRESH_1};
+    stat_cnt[STAT_IDLE] <= stat_cnt[STAT_IDLE] + {31'b0, state == ST_IDLE && !any_request};
+    stat_cnt[STAT_WAIT_CPU] <= stat_cnt[STAT_WAIT_CPU] + {31'b0, sync_word_pending && !sync_word_take};
+    stat_cnt[STAT_WAIT_BRIDGE] <= stat_cnt[STAT_WAIT_BRIDGE] + {31'b0, word_rd_queue | word_wr_queue};
+    stat_cnt[STAT_WAIT_VIDEO] <= stat_cnt[STAT_WAIT_VIDEO] + {31'b0, burst_rd_queue};
+    stat_cnt[STAT_WAIT_BURSTWR] <= stat_cnt[STAT_WAIT_BURSTWR] + {31'b0, burstwr_queue};
+
+    if(burst_rd) begin
+        stat_video_run <= 1;
+        stat_video_lat <= 1;
+    end else if(stat_video_run) begin
+        stat_video_lat <= stat_video_lat + 1'b1;
+        if(burst_data_valid) begin
+            stat_video_run <= 0;
+            if(stat_video_lat > stat_cnt[STAT_VIDEO_MAX_LAT])
+                stat_cnt[STAT_VIDEO_MAX_LAT] <= stat_video_lat;
+        end
+    end
+
+    if(stat_clear || ~reset_n_s) begin
+        for(stat_i = 0; stat_i < STAT_COUNT; stat_i = stat_i + 1)
+            stat_cnt[stat_i] <= 0;
+        stat_video_run <= 0;
     end
 end
 
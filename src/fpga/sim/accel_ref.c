@@ -0,0 +1,65 @@
+/*
+ * Bit-exact reference of the dot product accelerators
+ * See accel_ref.h for the arithmetic rules being modelled.
+ */
+
+#include "accel_ref.h"
+
+/* 64-bit wrapping add without signed overflow UB */
+static inline int64_t wrap_add(int64_t acc, int64_t x) {
+    return (int64_t)((uint64_t)acc + (uint64_t)x);
+}
+
+static inline int64_t mul_q16(int32_t a, int32_t b) {
+    return (int64_t)a * (int64_t)b;
+}
+
+int64_t accel_ref_dot(const int32_t *a, const int32_t *b, uint32_t n) {
+    int64_t acc = 0;
+    for (uint32_t i = 0; i < n; i++) {
+        acc = wrap_add(acc, mul_q16(a[i], b[i]));
+    }
+    return acc;
+}
+
+int64_t accel_ref_dot_cache(const int32_t *cache, uint32_t row_offset,
+                            const int32_t *b, uint32_t n) {
+    int64_t acc = 0;
+    for (uint32_t i = 0; i < n; i++) {
+        uint32_t addr = (row_offset + i) % ACCEL_REF_CACHE_SIZE;
+        acc = wrap_add(acc, mul_q16(cache[addr], b[i]));
+    }
+    return acc;
+}
+
+void accel_ref_q4_dequant(const uint32_t *blocks, int32_t *out, uint32_t n) {
+    for (uint32_t i = 0; i < n; i++) {
+        const uint32_t *block = &blocks[(i / ACCEL_REF_Q4_BLOCK) * ACCEL_REF_Q4_WORDS];
+        uint32_t j = i % ACCEL_REF_Q4_BLOCK;
+        uint32_t q = (block[1 + j / 8] >> ((j % 8) * 4)) & 0xF;
+        /* 4-bit signed times 32-bit scale, low 32 bits kept */
+        out[i] = (int32_t)((uint32_t)((int32_t)q - 8) * block[0]);
+    }
+}
+
+int64_t accel_ref_dot_q4(const uint32_t *blocks, const int32_t *b, uint32_t n) {
+    int64_t acc = 0;
+    for (uint32_t i = 0; i < n; i += ACCEL_REF_Q4_BLOCK) {
+        int32_t a[ACCEL_REF_Q4_BLOCK];
+        uint32_t count = n - i < ACCEL_REF_Q4_BLOCK ? n - i : ACCEL_REF_Q4_BLOCK;
+        accel_ref_q4_dequant(&blocks[(i / ACCEL_REF_Q4_BLOCK) * ACCEL_REF_Q4_WORDS], a, count);
+        acc = wrap_add(acc, accel_ref_dot(a, &b[i], count));
+    }
+    return acc;
+}
+
+int64_t accel_ref_dot8(const int32_t a[8], const int32_t b[8]) {
+    /* Same adder tree order as the RTL (the sum is exact mod 2^64 anyway) */
+    int64_t s1[4], s2[2];
+    for (int i = 0; i < 4; i++) {
+        s1[i] = wrap_add(mul_q16(a[2 * i], b[2 * i]), mul_q16(a[2 * i + 1], b[2 * i + 1]));
+    }
+    s2[0] = wrap_add(s1[0], s1[1]);
+    s2[1] = wrap_add(s1[2], s1[3]);
+    return wrap_add(s2[0], s2[1]);
+}
@@ -0,0 +1,67 @@
+/*
+ * Bit-exact reference of the dot product accelerators
+ *
+ * Models the arithmetic of dma_dot_product (0x50000000) and dot8_accel
+ * (0x51000000) as the RTL computes it, so results can be compared for
+ * equality rather than within a tolerance:
+ *
+ *   - operands are Q16.16 (int32); each product is the full 64-bit
+ *     signed 32x32 product (Q32.32)
+ *   - products are summed into a 64-bit accumulator that wraps modulo
+ *     2^64, with no saturation and no rounding
+ *   - the result registers return the raw Q32.32 sum;
+ *     accel_ref_to_q16() gives the Q16.16 value firmware uses
+ *     (arithmetic shift, i.e. truncation towards minus infinity)
+ *
+ * dma_dot_product specifics:
+ *   - LENGTH is at most 512, the size of the vector buffers; any length
+ *     from 1 up is exact (the buffered modes consume elements in pairs
+ *     and zero the lane past an odd LENGTH)
+ *   - weight cache reads wrap at 4096 elements
+ *   - Q4 mode dequantizes each weight to a 32-bit Q16.16 value first:
+ *     (q - 8) * scale, truncated to 32 bits
+ *
+ * Freestanding C (stdint only); used by the co-simulation harness
+ * (tb_accel.cpp) and usable as the firmware's software fallback.
+ */
+
+#ifndef ACCEL_REF_H
+#define ACCEL_REF_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define ACCEL_REF_MAX_LENGTH    512     /* Vector buffer elements */
+#define ACCEL_REF_CACHE_SIZE    4096    /* Weight cache elements */
+#define ACCEL_REF_Q4_BLOCK      32      /* Elements per Q4 block */
+#define ACCEL_REF_Q4_WORDS      5       /* Words per Q4 block */
+
+/* Q32.32 accumulator to Q16.16 */
+static inline int32_t accel_ref_to_q16(int64_t acc) {
+    return (int32_t)(acc >> 16);
+}
+
+/* Sum of a[i] * b[i] for i < n, wrapping modulo 2^64 */
+int64_t accel_ref_dot(const int32_t *a, const int32_t *b, uint32_t n);
+
+/* Weight cache mode: A is cache[(row_offset + i) % 4096], n elements */
+int64_t accel_ref_dot_cache(const int32_t *cache, uint32_t row_offset,
+                            const int32_t *b, uint32_t n);
+
+/* Dequantize Q4_Q16 blocks (5 words per 32 elements) to Q16.16 */
+void accel_ref_q4_dequant(const uint32_t *blocks, int32_t *out, uint32_t n);
+
+/* Q4 mode: A is n elements of Q4_Q16 blocks */
+int64_t accel_ref_dot_q4(const uint32_t *blocks, const int32_t *b, uint32_t n);
+
+/* dot8_accel: 8 products through the adder tree */
+int64_t accel_ref_dot8(const int32_t a[8], const int32_t b[8]);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ACCEL_REF_H */
@@ -0,0 +1,85 @@
+//
+// Behavioural altsyncram for simulation
+//
+// Covers the configurations the core uses: SINGLE_PORT, ROM and
+// BIDIR_DUAL_PORT, unregistered outputs, byte enables and new-data
+// read-during-write. Contents live in the DPI memory named by init_file,
+// which tb_soc.cpp fills from the MIF, or from the firmware image for
+// core/firmware.mif.
+//
+
+`default_nettype none
+
+module altsyncram #(
+    parameter operation_mode = "SINGLE_PORT",
+    parameter width_a = 32,
+    parameter widthad_a = 8,
+    parameter numwords_a = 256,
+    parameter width_b = 32,
+    parameter widthad_b = 1,
+    parameter numwords_b = 256,
+    parameter width_byteena_a = 1,
+    parameter width_byteena_b = 1,
+    parameter lpm_type = "altsyncram",
+    parameter outdata_reg_a = "UNREGISTERED",
+    parameter outdata_reg_b = "UNREGISTERED",
+    parameter init_file = "UNUSED",
+    parameter intended_device_family = "Cyclone V",
+    parameter read_during_write_mode_port_a = "NEW_DATA_NO_NBE_READ",
+    parameter read_during_write_mode_port_b = "NEW_DATA_NO_NBE_READ"
+) (
+    input wire                       clock0,
+    input wire                       clock1,
+    input wire [widthad_a-1:0]       address_a,
+    input wire [widthad_b-1:0]       address_b,
+    input wire [width_a-1:0]         data_a,
+    input wire [width_b-1:0]         data_b,
+    input wire                       wren_a,
+    input wire                       wren_b,
+    input wire [width_byteena_a-1:0] byteena_a,
+    input wire [width_byteena_b-1:0] byteena_b,
+    input wire                       rden_a,
+    input wire                       rden_b,
+    output reg [width_a-1:0]         q_a,
+    output reg [width_b-1:0]         q_b,
+    input wire                       aclr0,
+    input wire                       aclr1,
+    input wire                       addressstall_a,
+    input wire                       addressstall_b,
+    input wire                       clocken0,
+    input wire                       clocken1,
+    input wire                       clocken2,
+    input wire                       clocken3,
+    output wire                      eccstatus
+);
+
+`include "sim_mem.vh"
+
+localparam DUAL = operation_mode != "SINGLE_PORT" && operation_mode != "ROM";
+
+integer mem;
+initial mem = sim_mem_open(init_file, numwords_a, width_a);
+
+assign eccstatus = 1'b0;
+
+// Byte lanes to write; a single enable bit covers the whole word
+wire [31:0] mask_a = width_byteena_a == 1 ? 32'hFFFFFFFF : 32'(byteena_a);
+wire [31:0] mask_b = width_byteena_b == 1 ? 32'hFFFFFFFF : 32'(byteena_b);
+
+always @(posedge clock0) begin
+    if (wren_a && operation_mode != "ROM") begin
+        sim_mem_write(mem, 32'(address_a), 32'(data_a), mask_a);
+    end
+    q_a <= width_a'(sim_mem_read(mem, 32'(address_a)));
+end
+
+generate if (DUAL) begin : port_b
+    always @(posedge clock1) begin
+        if (wren_b) begin
+            sim_mem_write(mem, 32'(address_b), 32'(data_b), mask_b);
+        end
+        q_b <= width_b'(sim_mem_read(mem, 32'(address_b)));
+    end
+end endgenerate
+
+endmodule
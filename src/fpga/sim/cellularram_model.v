@@ -0,0 +1,75 @@
+//
+// Behavioural CellularRAM (cram0: two 8MB x16 dies on CE0#/CE1#)
+//
+// Asynchronous mode with the address/data multiplexed bus that psram.sv
+// drives: the address ({A[21:16], DQ}) is latched while ADV# is low, a
+// write takes the last DQ value seen while WE# is low and commits when
+// the chip is deselected, and a read drives DQ while OE# is low.
+//
+// Pins are sampled on the controller clock, so the model follows the
+// controller cycle by cycle rather than checking ns timings. Storage is
+// the "psram" DPI memory: one word per 16-bit location, indexed
+// {die, address}.
+//
+
+`default_nettype none
+
+module cellularram_model (
+    input wire         clk,
+    input wire [21:16] a,
+    inout wire [15:0]  dq,
+    input wire         adv_n,
+    input wire         ce0_n,
+    input wire         ce1_n,
+    input wire         oe_n,
+    input wire         we_n,
+    input wire         ub_n,
+    input wire         lb_n
+);
+
+`include "sim_mem.vh"
+
+integer mem;
+initial mem = sim_mem_open("psram", 2 * 4 * 1024 * 1024, 16);
+
+wire selected = !ce0_n || !ce1_n;
+
+reg [22:0] addr;            // {die, 22-bit halfword address}
+reg        write_active;
+reg [15:0] write_data;
+reg [1:0]  write_mask;
+
+reg        dq_oe;
+reg [15:0] dq_out;
+assign dq = dq_oe ? dq_out : 16'bz;
+
+initial begin
+    write_active = 0;
+    dq_oe = 0;
+end
+
+always @(posedge clk) begin
+    if (selected && !adv_n) begin
+        addr <= {!ce1_n, a, dq};
+    end
+
+    // Write: keep the latest data while WE# is low, commit at the end
+    if (selected && !we_n) begin
+        write_active <= 1;
+        if (adv_n) begin
+            write_data <= dq;
+            write_mask <= {!ub_n, !lb_n};
+        end
+    end else if (write_active) begin
+        write_active <= 0;
+        sim_mem_write(mem, {9'b0, addr}, {16'b0, write_data}, {30'b0, write_mask});
+    end
+
+    // Read: drive DQ while OE# is low
+    dq_oe <= selected && we_n && !oe_n && adv_n;
+    if (selected && we_n && !oe_n) begin
+        dq_out <= 16'(sim_mem_read(mem, {9'b0, addr}));
+    end
+end
+
+endmodule
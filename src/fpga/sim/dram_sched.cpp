@@ -0,0 +1,718 @@
+//
+// Trace-driven SDRAM scheduling simulator
+//
+// Replays a request trace against a cycle-level model of the AS4C32M16
+// (4 banks x 8192 rows x 1024 columns x 16 bits, single-data-rate, one
+// command per clock) under different controller policies, so scheduling
+// changes to io_sdram.v can be compared before they are written in RTL.
+//
+// Timings default to io_sdram's TIMING_* constants (clocks of
+// clk_ram_controller); addresses are io_sdram's linear 25-bit
+// 16-bit-word addresses, split into bank/row/column by its ADDR_MAP
+// (--map, default xor as core_top).
+//
+// Policies:
+//   closed      io_sdram today: one request at a time, ACT - column
+//               accesses - PRECHARGE, next request after tRP
+//   open        one request at a time, rows left open; a row hit skips
+//               PRECHARGE/ACT
+//   interleave  closed-page, but PRECHARGE/ACT for the next requests in
+//               other banks overlap the current transfer
+//   reorder     open-page with overlap, first-ready/first-come: row hits
+//               go first, video bursts close to their deadline go before
+//               everything
+//
+// Trace format (one request per line, '#' starts a comment):
+//   <cycle> <source> <R|W> <addr> <beats> [deadline]
+// source is cpu, video, bridge or accel; beats are 16-bit transfers;
+// deadline is an absolute cycle (video requests default to arrival plus
+// one scanline, --video-deadline). Vsim_soc --sdram-trace writes this
+// format; --synth generates one of the built-in workloads instead.
+//
+// Usage: dram_sched [options] [trace]
+//   --policy P          closed, open, interleave, reorder or all (default all)
+//   --synth W           dashboard, inference, boot or mixed
+//   --cycles N          length of a synthesised trace (default one frame)
+//   --seed N            synthesis seed (default 1)
+//   --map M             io_sdram address mapping: linear, rowbank or xor
+//   --video-deadline N  cycles a video line may take (default 4333)
+//   --tRCD/--tRP/--tRC/--tRAS/--tRRD/--tRFC/--tWR/--CL/--tREFI N
+//                       override timings
+//
+
+#include <algorithm>
+#include <cinttypes>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <random>
+#include <string>
+#include <vector>
+
+// ============================================
+// Configuration
+// ============================================
+
+// io_sdram.v TIMING_* at clk_ram_controller; tREFI is its 10-bit refresh_count
+struct Timing {
+    int cl = 3;
+    int rcd = 3;    // TIMING_ACT_RW
+    int rp = 3;     // TIMING_PRECHARGE
+    int rc = 9;     // TIMING_ACT_ACT
+    int ras = 7;    // TIMING_ACT_PRECHG
+    int rrd = 2;    // not in io_sdram (one bank at a time); datasheet 12ns
+    int rfc = 12;   // TIMING_AUTOREFRESH
+    int wr = 3;     // TIMING_WRITE
+    int refi = 1024;
+};
+
+static const double CLOCK_MHZ = 133.12;
+static const int BANKS = 4;
+static const uint64_t LINE_CYCLES = 4333;       // 400 pixels at 12.288 MHz
+static const uint64_t FRAME_CYCLES = LINE_CYCLES * 512;
+static const int LOOKAHEAD = 4;                 // requests prepared ahead
+static const uint64_t NEVER = ~0ull;
+
+enum Policy { POLICY_CLOSED, POLICY_OPEN, POLICY_INTERLEAVE, POLICY_REORDER, POLICY_COUNT };
+static const char *policy_names[POLICY_COUNT] = {"closed", "open", "interleave", "reorder"};
+
+enum Source { SRC_CPU, SRC_VIDEO, SRC_BRIDGE, SRC_ACCEL, SRC_COUNT };
+static const char *source_names[SRC_COUNT] = {"cpu", "video", "bridge", "accel"};
+
+// io_sdram ADDR_MAP_*: column is always [9:0]
+enum AddrMap { MAP_LINEAR, MAP_ROW_BANK, MAP_XOR, MAP_COUNT };
+static const char *map_names[MAP_COUNT] = {"linear", "rowbank", "xor"};
+static AddrMap addr_map = MAP_XOR;
+
+static int bank_of(uint32_t addr) {
+    if (addr_map == MAP_LINEAR) return (addr >> 23) & 3;
+    int bank = (addr >> 10) & 3;
+    if (addr_map == MAP_XOR) {
+        for (uint32_t row = addr >> 12; row; row >>= 2) bank ^= row & 3;
+    }
+    return bank;
+}
+static int row_of(uint32_t addr) {
+    return addr_map == MAP_LINEAR ? (addr >> 10) & 0x1FFF : (addr >> 12) & 0x1FFF;
+}
+
+// ============================================
+// Requests and traces
+// ============================================
+
+struct Request {
+    uint64_t arrival;
+    int source;
+    bool write;
+    uint32_t addr;          // 16-bit word address
+    int beats;
+    uint64_t deadline;      // NEVER if none
+
+    // Scheduling state
+    int issued = 0;
+    uint64_t first_cmd = NEVER;
+    uint64_t done = NEVER;
+    bool row_hit = false;
+};
+
+static bool parse_source(const char *name, int &source) {
+    for (int s = 0; s < SRC_COUNT; s++) {
+        if (!std::strcmp(name, source_names[s])) {
+            source = s;
+            return true;
+        }
+    }
+    return false;
+}
+
+static bool load_trace(const char *path, uint64_t video_deadline, std::vector<Request> &out) {
+    FILE *f = std::fopen(path, "r");
+    if (!f) {
+        std::fprintf(stderr, "error: cannot open %s\n", path);
+        return false;
+    }
+    char line[256];
+    int lineno = 0;
+    while (std::fgets(line, sizeof(line), f)) {
+        lineno++;
+        char *hash = std::strchr(line, '#');
+        if (hash) *hash = 0;
+        char source[16], op[4];
+        unsigned long long cycle, deadline;
+        int addr, beats;
+        int n = std::sscanf(line, "%llu %15s %3s %i %i %llu", &cycle, source, op, &addr, &beats,
+                            &deadline);
+        if (n <= 0) continue;
+        Request r;
+        if (n < 5 || !parse_source(source, r.source) || (op[0] != 'R' && op[0] != 'W') || beats <= 0) {
+            std::fprintf(stderr, "error: %s:%d: bad request\n", path, lineno);
+            std::fclose(f);
+            return false;
+        }
+        r.arrival = cycle;
+        r.write = op[0] == 'W';
+        r.addr = (uint32_t)addr & 0x1FFFFFF;
+        r.beats = beats;
+        r.deadline = n == 6 ? deadline : r.source == SRC_VIDEO ? cycle + video_deadline : NEVER;
+        out.push_back(r);
+    }
+    std::fclose(f);
+    std::stable_sort(out.begin(), out.end(),
+                     [](const Request &a, const Request &b) { return a.arrival < b.arrival; });
+    return true;
+}
+
+// ============================================
+// Synthetic workloads
+// ============================================
+
+struct Synth {
+    std::mt19937 rng;
+    uint64_t cycles;
+    uint64_t video_deadline;
+    std::vector<Request> out;
+
+    Synth(uint32_t seed, uint64_t cycles, uint64_t video_deadline)
+        : rng(seed), cycles(cycles), video_deadline(video_deadline) {}
+
+    void add(uint64_t t, int source, bool write, uint32_t addr, int beats, uint64_t deadline = NEVER) {
+        if (t >= cycles) return;
+        Request r;
+        r.arrival = t;
+        r.source = source;
+        r.write = write;
+        r.addr = addr & 0x1FFFFFF;
+        r.beats = beats;
+        r.deadline = deadline;
+        out.push_back(r);
+    }
+
+    // video_scanout: 320-beat line fetched one line ahead, 240 active lines
+    void video(uint32_t fb_base) {
+        for (uint64_t frame = 0; frame * FRAME_CYCLES < cycles; frame++) {
+            for (int line = 0; line < 240; line++) {
+                uint64_t t = frame * FRAME_CYCLES + (15 + line) * LINE_CYCLES;
+                add(t, SRC_VIDEO, false, fb_base + line * 320, 320, t + video_deadline);
+            }
+        }
+    }
+
+    // CPU cache refills: 8 consecutive word reads (2 beats each) at a random
+    // line, about one refill per period cycles, plus scattered word writes
+    void cpu(uint32_t base, uint32_t span, uint64_t period, double write_share) {
+        std::exponential_distribution<double> gap(1.0 / period);
+        std::uniform_real_distribution<double> u(0, 1);
+        for (double t = gap(rng); t < cycles; t += gap(rng)) {
+            uint32_t line = base + ((rng() % (span / 16)) * 16);
+            if (u(rng) < write_share) {
+                add((uint64_t)t, SRC_CPU, true, line + (rng() % 8) * 2, 2);
+                continue;
+            }
+            for (int w = 0; w < 8; w++) add((uint64_t)t + w * 14, SRC_CPU, false, line + w * 2, 2);
+        }
+    }
+
+    // Framebuffer drawing: sequential word writes through the draw buffer
+    void draw(uint32_t fb_base, uint64_t period) {
+        uint32_t offset = 0;
+        for (uint64_t t = 0; t < cycles; t += period) {
+            add(t, SRC_CPU, true, fb_base + offset, 2);
+            offset = (offset + 2) % (320 * 240);
+        }
+    }
+
+    // Accelerator weight stream: sequential 64-beat bursts
+    void accel(uint32_t base, uint64_t period) {
+        uint32_t offset = 0;
+        for (uint64_t t = 0; t < cycles; t += period) {
+            add(t, SRC_ACCEL, false, base + offset, 64);
+            offset += 64;
+        }
+    }
+
+    // Bridge data slot load: sequential 256-beat write bursts
+    void bridge(uint32_t base, uint64_t period) {
+        uint32_t offset = 0;
+        for (uint64_t t = 0; t < cycles; t += period) {
+            add(t, SRC_BRIDGE, true, base + offset, 256);
+            offset += 256;
+        }
+    }
+};
+
+// Framebuffers at SDRAM 0 and 1MB, firmware image at 3MB, model above 4MB
+// (16-bit word addresses)
+static const uint32_t FB0 = 0x000000, FB1 = 0x080000;
+static const uint32_t FW_IMAGE = 0x180000, MODEL = 0x200000;
+
+static bool synthesise(const char *name, uint32_t seed, uint64_t cycles, uint64_t video_deadline,
+                       std::vector<Request> &out) {
+    Synth s(seed, cycles, video_deadline);
+    std::string w = name;
+    if (w == "dashboard") {
+        s.video(FB0);
+        s.draw(FB1, 24);
+        s.cpu(FW_IMAGE, 0x10000, 400, 0.2);
+    } else if (w == "inference") {
+        s.video(FB0);
+        s.accel(MODEL, 90);
+        s.cpu(MODEL + 0x400000, 0x40000, 250, 0.3);
+    } else if (w == "boot") {
+        s.video(FB0);
+        s.bridge(MODEL, 600);
+        s.cpu(FW_IMAGE, 0x10000, 600, 0.1);
+    } else if (w == "mixed") {
+        s.video(FB0);
+        s.draw(FB1, 60);
+        s.accel(MODEL, 150);
+        s.bridge(MODEL + 0x800000, 2400);
+        s.cpu(FW_IMAGE, 0x10000, 300, 0.2);
+    } else {
+        std::fprintf(stderr, "error: unknown workload %s\n", name);
+        return false;
+    }
+    out = std::move(s.out);
+    std::stable_sort(out.begin(), out.end(),
+                     [](const Request &a, const Request &b) { return a.arrival < b.arrival; });
+    return true;
+}
+
+// ============================================
+// Controller model
+// ============================================
+
+struct Bank {
+    bool open = false;
+    int row = 0;
+    int owner = -1;             // request the ACT was issued for
+    uint64_t t_act = 0, t_pre = 0, t_write = 0;
+    bool any_act = false, any_pre = false, any_write = false;
+};
+
+struct Stats {
+    uint64_t cycles = 0;
+    uint64_t beats = 0;
+    uint64_t commands = 0;
+    uint64_t acts = 0;
+    uint64_t refreshes = 0;
+    uint64_t row_hits = 0;
+    uint64_t requests = 0;
+    uint64_t deadline_misses = 0;
+    uint64_t worst_late = 0;
+    std::vector<uint64_t> latency[SRC_COUNT];
+};
+
+class Controller {
+public:
+    Controller(Policy policy, const Timing &t, std::vector<Request> reqs)
+        : policy(policy), t(t), reqs(std::move(reqs)) {}
+
+    Stats run();
+
+private:
+    Policy policy;
+    Timing t;
+    std::vector<Request> reqs;
+    Bank banks[BANKS];
+    uint64_t now = 0;
+    std::deque<int> queue;      // arrived, not finished, in arrival order
+    int current = -1;           // request whose column accesses are in progress
+    uint64_t start_gate = 0;    // serial policies: no new request before this
+    int closing_bank = -1;      // closed: bank of the finished request awaiting PRECHARGE
+    uint64_t closing_after = 0;
+    uint64_t next_refresh;
+    uint64_t refresh_busy_until = 0;
+    uint64_t last_read = 0, last_act = 0;
+    bool any_read = false, any_act = false;
+    Stats stats;
+
+    bool open_page() const { return policy == POLICY_OPEN || policy == POLICY_REORDER; }
+    bool overlap() const { return policy == POLICY_INTERLEAVE || policy == POLICY_REORDER; }
+
+    uint32_t beat_addr(const Request &r) const { return r.addr + r.issued; }
+
+    bool can_act(int b) const {
+        const Bank &k = banks[b];
+        return !k.open && now >= refresh_busy_until && (!k.any_pre || now >= k.t_pre + t.rp) &&
+               (!k.any_act || now >= k.t_act + t.rc) && (!any_act || now >= last_act + t.rrd);
+    }
+    bool can_pre(int b) const {
+        const Bank &k = banks[b];
+        return k.open && now >= k.t_act + t.ras && (!k.any_write || now >= k.t_write + t.wr);
+    }
+    bool row_ready(const Request &r) const {
+        const Bank &k = banks[bank_of(beat_addr(r))];
+        return k.open && k.row == row_of(beat_addr(r)) && now >= k.t_act + t.rcd;
+    }
+
+    void act(int b, int row, int owner) {
+        Bank &k = banks[b];
+        k.open = true;
+        k.row = row;
+        k.owner = owner;
+        k.t_act = now;
+        k.any_act = true;
+        last_act = now;
+        any_act = true;
+        stats.acts++;
+        stats.commands++;
+    }
+    void pre(int b) {
+        Bank &k = banks[b];
+        k.open = false;
+        k.t_pre = now;
+        k.any_pre = true;
+        stats.commands++;
+    }
+
+    int pick() const;
+    bool urgent(const Request &r) const;
+    bool row_needed_by_older(int b, int row, size_t before) const;
+    bool column(int id);
+    bool prepare(int id);
+    void finish(int id);
+    void close_bank();
+    bool refresh();
+};
+
+bool Controller::urgent(const Request &r) const {
+    // Bursts are not preempted, so leave room for one long transfer ahead
+    // of this one plus its own
+    return r.deadline != NEVER && r.deadline < now + 2 * r.beats + 512;
+}
+
+// Next request to serve once the current one has finished
+int Controller::pick() const {
+    if (queue.empty()) return -1;
+    if (policy != POLICY_REORDER) return queue.front();
+
+    for (int id : queue) {
+        if (urgent(reqs[id])) return id;
+    }
+    for (int id : queue) {
+        const Request &r = reqs[id];
+        const Bank &k = banks[bank_of(beat_addr(r))];
+        if (k.open && k.row == row_of(beat_addr(r))) return id;
+    }
+    return queue.front();
+}
+
+bool Controller::row_needed_by_older(int b, int row, size_t before) const {
+    for (size_t i = 0; i < before && i < queue.size(); i++) {
+        const Request &r = reqs[queue[i]];
+        if (bank_of(beat_addr(r)) == b && row_of(beat_addr(r)) == row) return true;
+    }
+    return false;
+}
+
+// Issue the next column access of request id if its row is ready
+bool Controller::column(int id) {
+    Request &r = reqs[id];
+    int b = bank_of(beat_addr(r));
+    if (b == closing_bank || !row_ready(r)) return false;
+    // Bus turnaround: a write may not drive DQ while read data is returning
+    if (r.write && any_read && now < last_read + t.cl + 1) return false;
+
+    Bank &k = banks[b];
+    if (r.issued == 0) {
+        r.first_cmd = now;
+        r.row_hit = k.owner != id;
+    }
+    if (r.write) {
+        k.t_write = now;
+        k.any_write = true;
+    } else {
+        last_read = now;
+        any_read = true;
+    }
+    k.owner = id;
+    r.issued++;
+    stats.beats++;
+    stats.commands++;
+    if (r.issued == r.beats) finish(id);
+    return true;
+}
+
+// Issue the PRECHARGE or ACT request id needs next, if allowed now
+bool Controller::prepare(int id) {
+    const Request &r = reqs[id];
+    int b = bank_of(beat_addr(r));
+    int row = row_of(beat_addr(r));
+    const Bank &k = banks[b];
+    if (b == closing_bank || (k.open && k.row == row)) return false;
+    if (k.open) {
+        if (!can_pre(b)) return false;
+        pre(b);
+        return true;
+    }
+    if (!can_act(b)) return false;
+    act(b, row, id);
+    return true;
+}
+
+void Controller::finish(int id) {
+    Request &r = reqs[id];
+    r.done = r.write ? now : now + t.cl;
+    queue.erase(std::find(queue.begin(), queue.end(), id));
+    current = -1;
+
+    stats.requests++;
+    stats.latency[r.source].push_back(r.done - r.arrival);
+    if (r.row_hit) stats.row_hits++;
+    if (r.deadline != NEVER && r.done > r.deadline) {
+        stats.deadline_misses++;
+        stats.worst_late = std::max(stats.worst_late, r.done - r.deadline);
+    }
+
+    if (!open_page()) {
+        // io_sdram waits for the read data (or tWR) before PRECHARGE
+        closing_bank = bank_of(r.addr + r.beats - 1);
+        closing_after = r.write ? now + 1 : now + t.cl;
+    }
+    // closed: the gate opens once the PRECHARGE has completed (close_bank)
+    start_gate = policy == POLICY_CLOSED ? NEVER : now + 1;
+}
+
+void Controller::close_bank() {
+    pre(closing_bank);
+    closing_bank = -1;
+    if (policy == POLICY_CLOSED) start_gate = now + t.rp + 1;
+}
+
+// Refresh once due and no transfer is in progress: close every bank, then
+// REF. Returns true while it holds the command bus.
+bool Controller::refresh() {
+    if (now < next_refresh || current >= 0) return false;
+    if (closing_bank >= 0) {
+        if (now >= closing_after && can_pre(closing_bank)) {
+            close_bank();
+        }
+        return true;
+    }
+    for (int b = 0; b < BANKS; b++) {
+        if (!banks[b].open) continue;
+        if (can_pre(b)) pre(b);
+        return true;
+    }
+    for (int b = 0; b < BANKS; b++) {
+        if (banks[b].any_pre && now < banks[b].t_pre + t.rp) return true;
+    }
+    stats.refreshes++;
+    stats.commands++;
+    refresh_busy_until = now + t.rfc;
+    next_refresh += t.refi;
+    for (Bank &k : banks) k.owner = -1;
+    return true;
+}
+
+Stats Controller::run() {
+    size_t next_arrival = 0;
+    next_refresh = t.refi;
+
+    while (next_arrival < reqs.size() || !queue.empty() || current >= 0 || closing_bank >= 0) {
+        while (next_arrival < reqs.size() && reqs[next_arrival].arrival <= now) {
+            queue.push_back((int)next_arrival++);
+        }
+        if (queue.empty() && current < 0 && closing_bank < 0) {
+            // Idle: skip ahead to the next arrival or refresh
+            uint64_t next = std::min(reqs[next_arrival].arrival, next_refresh);
+            if (next > now) {
+                now = next;
+                continue;
+            }
+        }
+
+        bool issued = now < refresh_busy_until;
+
+        if (!issued) issued = refresh();
+
+        // Closed page: PRECHARGE the finished request's bank
+        if (!issued && closing_bank >= 0 && now >= closing_after && can_pre(closing_bank)) {
+            close_bank();
+            issued = true;
+        }
+
+        if (!issued && current < 0 && now >= start_gate) current = pick();
+
+        if (!issued && current >= 0) issued = column(current) || prepare(current);
+
+        // Overlap: get the banks of the next requests ready meanwhile
+        if (!issued && overlap() && now < next_refresh) {
+            int busy_bank = current >= 0 ? bank_of(beat_addr(reqs[current])) : -1;
+            size_t n = 0;
+            for (size_t i = 0; i < queue.size() && n < (size_t)LOOKAHEAD && !issued; i++) {
+                int id = queue[i];
+                if (id == current) continue;
+                n++;
+                const Request &r = reqs[id];
+                int b = bank_of(beat_addr(r));
+                if (b == busy_bank) continue;
+                if (banks[b].open && banks[b].row != row_of(beat_addr(r)) &&
+                    row_needed_by_older(b, banks[b].row, i)) {
+                    continue;
+                }
+                issued = prepare(id);
+            }
+        }
+
+        now++;
+    }
+
+    uint64_t last_done = 0;
+    for (const Request &r : reqs) last_done = std::max(last_done, r.done);
+    stats.cycles = last_done + 1;
+    return stats;
+}
+
+// ============================================
+// Report
+// ============================================
+
+static uint64_t percentile(std::vector<uint64_t> &v, double p) {
+    if (v.empty()) return 0;
+    std::sort(v.begin(), v.end());
+    size_t i = (size_t)(p * (v.size() - 1) + 0.5);
+    return v[i];
+}
+
+static void report(Policy policy, Stats &s, uint64_t deadlines) {
+    double seconds = s.cycles / (CLOCK_MHZ * 1e6);
+    std::printf("%-10s %8.1f %5.1f%% %5.1f%% %6" PRIu64 "/%-6" PRIu64, policy_names[policy],
+                s.beats * 2 / seconds / 1e6, 100.0 * s.beats / s.cycles,
+                s.requests ? 100.0 * s.row_hits / s.requests : 0.0, s.deadline_misses, deadlines);
+    for (int src = 0; src < SRC_COUNT; src++) {
+        auto &v = s.latency[src];
+        if (v.empty()) {
+            std::printf("  %-26s", "-");
+            continue;
+        }
+        char buf[64];
+        std::snprintf(buf, sizeof(buf), "%" PRIu64 "/%" PRIu64 "/%" PRIu64 "/%" PRIu64,
+                      percentile(v, 0.5), percentile(v, 0.95), percentile(v, 0.99),
+                      percentile(v, 1.0));
+        std::printf("  %-26s", buf);
+    }
+    std::printf("\n");
+    if (s.deadline_misses) {
+        std::printf("%-10s worst deadline miss %" PRIu64 " cycles late\n", "", s.worst_late);
+    }
+}
+
+static void usage() {
+    std::fprintf(stderr,
+                 "usage: dram_sched [--policy closed|open|interleave|reorder|all]\n"
+                 "                  [--synth dashboard|inference|boot|mixed] [--cycles N] [--seed N]\n"
+                 "                  [--map linear|rowbank|xor]\n"
+                 "                  [--video-deadline N] [--tRCD N] [--tRP N] [--tRC N] [--tRAS N]\n"
+                 "                  [--tRRD N] [--tRFC N] [--tWR N] [--CL N] [--tREFI N] [trace]\n");
+}
+
+int main(int argc, char **argv) {
+    Timing timing;
+    const char *trace = nullptr;
+    const char *synth = nullptr;
+    std::string policy = "all";
+    uint64_t cycles = FRAME_CYCLES;
+    uint32_t seed = 1;
+    uint64_t video_deadline = LINE_CYCLES;
+
+    struct {
+        const char *name;
+        int *value;
+    } timing_opts[] = {{"--tRCD", &timing.rcd}, {"--tRP", &timing.rp},   {"--tRC", &timing.rc},
+                       {"--tRAS", &timing.ras}, {"--tRRD", &timing.rrd}, {"--tRFC", &timing.rfc},
+                       {"--tWR", &timing.wr},   {"--CL", &timing.cl},     {"--tREFI", &timing.refi}};
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        bool matched = false;
+        for (auto &opt : timing_opts) {
+            if (arg == opt.name && i + 1 < argc) {
+                *opt.value = std::atoi(argv[++i]);
+                matched = true;
+            }
+        }
+        if (matched) continue;
+        if (arg == "--policy" && i + 1 < argc) {
+            policy = argv[++i];
+        } else if (arg == "--synth" && i + 1 < argc) {
+            synth = argv[++i];
+        } else if (arg == "--cycles" && i + 1 < argc) {
+            cycles = std::strtoull(argv[++i], nullptr, 0);
+        } else if (arg == "--seed" && i + 1 < argc) {
+            seed = (uint32_t)std::strtoul(argv[++i], nullptr, 0);
+        } else if (arg == "--map" && i + 1 < argc) {
+            std::string name = argv[++i];
+            int m = 0;
+            while (m < MAP_COUNT && name != map_names[m]) m++;
+            if (m == MAP_COUNT) {
+                usage();
+                return 2;
+            }
+            addr_map = (AddrMap)m;
+        } else if (arg == "--video-deadline" && i + 1 < argc) {
+            video_deadline = std::strtoull(argv[++i], nullptr, 0);
+        } else if (arg[0] != '-' && !trace) {
+            trace = argv[i];
+        } else {
+            usage();
+            return 2;
+        }
+    }
+    if (!trace == !synth) {
+        usage();
+        return 2;
+    }
+
+    std::vector<Request> reqs;
+    if (trace ? !load_trace(trace, video_deadline, reqs)
+              : !synthesise(synth, seed, cycles, video_deadline, reqs)) {
+        return 2;
+    }
+    if (reqs.empty()) {
+        std::fprintf(stderr, "error: no requests\n");
+        return 2;
+    }
+
+    uint64_t counts[SRC_COUNT] = {0}, beats = 0, deadlines = 0;
+    for (const Request &r : reqs) {
+        counts[r.source]++;
+        deadlines += r.deadline != NEVER;
+        beats += r.beats;
+    }
+    std::printf("%zu requests (", reqs.size());
+    for (int s = 0, first = 1; s < SRC_COUNT; s++) {
+        if (!counts[s]) continue;
+        std::printf("%s%" PRIu64 " %s", first ? "" : ", ", counts[s], source_names[s]);
+        first = 0;
+    }
+    std::printf("), %" PRIu64 " beats over %" PRIu64 " cycles\n", beats, reqs.back().arrival + 1);
+    std::printf("address map: %s\n", map_names[addr_map]);
+    std::printf("timing: CL %d tRCD %d tRP %d tRC %d tRAS %d tRRD %d tRFC %d tWR %d tREFI %d\n\n",
+                timing.cl, timing.rcd, timing.rp, timing.rc, timing.ras, timing.rrd, timing.rfc,
+                timing.wr, timing.refi);
+
+    std::printf("%-10s %8s %6s %6s %13s", "policy", "MB/s", "data", "rowhit", "missed/due");
+    for (int s = 0; s < SRC_COUNT; s++) {
+        char buf[48];
+        std::snprintf(buf, sizeof(buf), "%s p50/p95/p99/max", source_names[s]);
+        std::printf("  %-26s", buf);
+    }
+    std::printf("\n");
+
+    bool any = false;
+    for (int p = 0; p < POLICY_COUNT; p++) {
+        if (policy != "all" && policy != policy_names[p]) continue;
+        any = true;
+        Controller c((Policy)p, timing, reqs);
+        Stats s = c.run();
+        report((Policy)p, s, deadlines);
+    }
+    if (!any) {
+        std::fprintf(stderr, "error: unknown policy %s\n", policy.c_str());
+        return 2;
+    }
+    return 0;
+}
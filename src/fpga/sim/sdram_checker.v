@@ -0,0 +1,249 @@
+//
+// SDRAM protocol and timing checker
+//
+// Watches the phy_* pins and tracks per-bank state like the chip does.
+// Commands are sampled on the rising edge (as sdram_model registers
+// them) and every command is checked against the minimum spacing from
+// the AS4C32M16 datasheet, in clocks at 133.12 MHz (7.51 ns):
+//
+//   tRCD 18ns  ACT -> READ/WRITE, same bank        3
+//   tRP  18ns  PRECHARGE -> ACT/REF/LMR            3
+//   tRAS 48ns  ACT -> PRECHARGE, same bank         7
+//   tRC  66ns  ACT -> ACT, same bank               9
+//   tRRD 12ns  ACT -> ACT, any bank                2
+//   tRFC 80ns  REF -> any command                  11
+//   tWR  15ns  WRITE -> PRECHARGE, same bank       2
+//
+// Refresh is checked as JEDEC allows it: one REF is owed every tREFI
+// (7.8us, 1039 clocks), at most 8 may be outstanding, and two REFs may
+// be at most 9 tREFI apart however pull-in and postponement combine.
+// Command misuse (column access to an idle bank, ACT to an open one, REF
+// or LMR with banks open) counts as a violation too.
+//
+// Each violation is reported with $display (the first MAX_REPORTS of
+// them) and counted on the violations output. The final block prints
+// command-bus and data-bus utilisation, the row-hit rate (column
+// accesses that reuse a row already accessed since its ACT) and refresh
+// statistics. Checking starts at the first command after CKE rises.
+//
+
+`default_nettype none
+
+module sdram_checker #(
+    parameter T_RCD = 3,
+    parameter T_RP = 3,
+    parameter T_RAS = 7,
+    parameter T_RC = 9,
+    parameter T_RRD = 2,
+    parameter T_RFC = 11,
+    parameter T_WR = 2,
+    parameter T_REFI = 1039,
+    parameter MAX_POSTPONED = 8,
+    parameter MAX_REPORTS = 20
+) (
+    input wire        clk,
+    input wire        cke,
+    input wire        ras_n,
+    input wire        cas_n,
+    input wire        we_n,
+    input wire [1:0]  ba,
+    input wire [12:0] a,
+
+    output reg [31:0] violations
+);
+
+localparam CMD_NOP     = 3'b111;
+localparam CMD_ACT     = 3'b011;
+localparam CMD_READ    = 3'b101;
+localparam CMD_WRITE   = 3'b100;
+localparam CMD_PRECHG  = 3'b010;
+localparam CMD_AUTOREF = 3'b001;
+localparam CMD_LMR     = 3'b000;
+
+wire [2:0] cmd = {ras_n, cas_n, we_n};
+
+// Cycle counter and per-bank timestamps of the last command of each kind
+reg  [63:0] now;
+reg         active;
+reg  [3:0]  bank_open;
+reg  [3:0]  row_used;           // a column access has hit this activation
+reg  [63:0] last_act [0:3];
+reg  [63:0] last_pre [0:3];
+reg  [63:0] last_wr [0:3];
+reg  [63:0] last_act_any;
+reg  [63:0] last_ref;
+
+// Refresh debt: +1 per tREFI elapsed, -1 per REF
+reg         refresh_started;
+reg  [31:0] refi_timer;
+integer     refresh_debt;
+integer     max_refresh_debt;
+reg  [63:0] max_refresh_gap;
+
+// Statistics
+reg  [63:0] stat_cycles;
+reg  [63:0] stat_commands;
+reg  [63:0] stat_act;
+reg  [63:0] stat_read;
+reg  [63:0] stat_write;
+reg  [63:0] stat_prechg;
+reg  [63:0] stat_refresh;
+reg  [63:0] stat_row_hits;
+
+integer i;
+
+initial begin
+    now = 0;
+    active = 0;
+    violations = 0;
+    bank_open = 0;
+    row_used = 0;
+    refresh_started = 0;
+    refi_timer = 0;
+    refresh_debt = 0;
+    max_refresh_debt = 0;
+    max_refresh_gap = 0;
+    last_act_any = 0;
+    last_ref = 0;
+    for (i = 0; i < 4; i = i + 1) begin
+        last_act[i] = 0;
+        last_pre[i] = 0;
+        last_wr[i] = 0;
+    end
+    stat_cycles = 0;
+    stat_commands = 0;
+    stat_act = 0;
+    stat_read = 0;
+    stat_write = 0;
+    stat_prechg = 0;
+    stat_refresh = 0;
+    stat_row_hits = 0;
+end
+
+task violation(input [8*48-1:0] what, input [63:0] gap, input integer need);
+    begin
+        if (violations < MAX_REPORTS)
+            $display("sdram_checker: cycle %0d bank %0d: %0s (%0d clocks, need %0d)",
+                     now, ba, what, gap, need);
+        violations = violations + 1;
+    end
+endtask
+
+task check_gap(input [8*48-1:0] what, input [63:0] since, input integer need);
+    begin
+        if (now - since < 64'(need)) violation(what, now - since, need);
+    end
+endtask
+
+task misuse(input [8*48-1:0] what);
+    begin
+        if (violations < MAX_REPORTS)
+            $display("sdram_checker: cycle %0d bank %0d: %0s (open banks %b)",
+                     now, ba, what, bank_open);
+        violations = violations + 1;
+    end
+endtask
+
+always @(posedge clk) begin
+    now <= now + 1;
+
+    if (cke && cmd != CMD_NOP) active <= 1;
+
+    if (active) begin
+        stat_cycles <= stat_cycles + 1;
+
+        // Refresh debt
+        if (refresh_started) begin
+            refi_timer <= refi_timer + 1;
+            if (refi_timer == T_REFI - 1) begin
+                refi_timer <= 0;
+                refresh_debt = refresh_debt + 1;
+                if (refresh_debt > max_refresh_debt) max_refresh_debt = refresh_debt;
+                if (refresh_debt == MAX_POSTPONED + 1)
+                    violation("refresh overdue: more than 8 tREFI outstanding", now - last_ref, T_REFI);
+            end
+        end
+    end
+
+    if (cke && cmd != CMD_NOP) begin
+        stat_commands <= stat_commands + 1;
+        check_gap("command during tRFC", last_ref, T_RFC);
+
+        case (cmd)
+            CMD_ACT: begin
+                stat_act <= stat_act + 1;
+                if (bank_open[ba]) misuse("ACT to an open bank");
+                check_gap("tRP: PRECHARGE to ACT", last_pre[ba], T_RP);
+                check_gap("tRC: ACT to ACT, same bank", last_act[ba], T_RC);
+                check_gap("tRRD: ACT to ACT", last_act_any, T_RRD);
+                bank_open[ba] <= 1;
+                row_used[ba] <= 0;
+                last_act[ba] <= now;
+                last_act_any <= now;
+            end
+            CMD_READ, CMD_WRITE: begin
+                if (cmd == CMD_READ) stat_read <= stat_read + 1;
+                else stat_write <= stat_write + 1;
+                if (!bank_open[ba]) misuse("column access to an idle bank");
+                check_gap("tRCD: ACT to READ/WRITE", last_act[ba], T_RCD);
+                if (row_used[ba]) stat_row_hits <= stat_row_hits + 1;
+                row_used[ba] <= 1;
+                if (cmd == CMD_WRITE) last_wr[ba] <= now;
+            end
+            CMD_PRECHG: begin
+                stat_prechg <= stat_prechg + 1;
+                for (i = 0; i < 4; i = i + 1) begin
+                    if ((a[10] || ba == i[1:0]) && bank_open[i]) begin
+                        if (now - last_act[i] < T_RAS)
+                            violation("tRAS: ACT to PRECHARGE", now - last_act[i], T_RAS);
+                        if (now - last_wr[i] < T_WR && last_wr[i] > last_act[i])
+                            violation("tWR: WRITE to PRECHARGE", now - last_wr[i], T_WR);
+                        bank_open[i] <= 0;
+                        last_pre[i] <= now;
+                    end
+                end
+            end
+            CMD_AUTOREF: begin
+                stat_refresh <= stat_refresh + 1;
+                if (|bank_open) misuse("AUTO REFRESH with banks open");
+                for (i = 0; i < 4; i = i + 1)
+                    check_gap("tRP: PRECHARGE to REF", last_pre[i], T_RP);
+                if (refresh_started) begin
+                    if (now - last_ref > max_refresh_gap) max_refresh_gap <= now - last_ref;
+                    if (now - last_ref > 64'(9 * T_REFI))
+                        violation("refresh gap over 9 tREFI", now - last_ref, 9 * T_REFI);
+                    if (refresh_debt > -MAX_POSTPONED) refresh_debt = refresh_debt - 1;
+                end
+                refresh_started <= 1;
+                last_ref <= now;
+            end
+            CMD_LMR: begin
+                if (|bank_open) misuse("LOAD MODE with banks open");
+                for (i = 0; i < 4; i = i + 1)
+                    check_gap("tRP: PRECHARGE to LMR", last_pre[i], T_RP);
+            end
+            default: ;
+        endcase
+    end
+end
+
+function integer permille(input [63:0] part, input [63:0] whole);
+    permille = whole == 0 ? 0 : 32'(part * 1000 / whole);
+endfunction
+
+final begin
+    $display("sdram: %0d cycles, %0d commands (command bus %0d.%0d%%), data bus %0d.%0d%%",
+             stat_cycles, stat_commands,
+             permille(stat_commands, stat_cycles) / 10, permille(stat_commands, stat_cycles) % 10,
+             permille(stat_read + stat_write, stat_cycles) / 10,
+             permille(stat_read + stat_write, stat_cycles) % 10);
+    $display("sdram: %0d ACT, %0d READ, %0d WRITE, %0d PRECHARGE, row hits %0d.%0d%%",
+             stat_act, stat_read, stat_write, stat_prechg,
+             permille(stat_row_hits, stat_read + stat_write) / 10,
+             permille(stat_row_hits, stat_read + stat_write) % 10);
+    $display("sdram: %0d refreshes, longest gap %0d clocks (limit %0d), max outstanding %0d",
+             stat_refresh, max_refresh_gap, 9 * T_REFI, max_refresh_debt);
+    $display("sdram: %0d protocol/timing violations", violations);
+end
+
+endmodule
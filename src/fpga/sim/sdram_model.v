@@ -0,0 +1,127 @@
+//
+// Behavioural AS4C32M16 SDRAM (64MB: 4 banks x 8192 rows x 1024 columns x 16)
+//
+// Commands are registered on the rising clock edge. Read data for a READ
+// registered at edge T0 is driven from edge T0+CL until edge T0+CL+1,
+// which is where io_sdram samples it (its PLL phase shift in hardware).
+// Supports the subset io_sdram uses: burst length 1, CAS latency 2 or 3
+// from the mode register, DQM write masks, per-bank row state.
+//
+// Protocol misuse (READ/WRITE to an idle bank, ACT to an open one,
+// AUTO REFRESH with a bank open) is reported with $display; storage is
+// the "sdram" DPI memory, indexed {bank, row, column}, one word per
+// 16-bit location.
+//
+
+`default_nettype none
+
+module sdram_model (
+    input wire        clk,
+    input wire        cke,
+    input wire        ras_n,
+    input wire        cas_n,
+    input wire        we_n,
+    input wire [1:0]  ba,
+    input wire [12:0] a,
+    inout wire [15:0] dq,
+    input wire [1:0]  dqm
+);
+
+`include "sim_mem.vh"
+
+localparam CMD_NOP     = 3'b111;
+localparam CMD_ACT     = 3'b011;
+localparam CMD_READ    = 3'b101;
+localparam CMD_WRITE   = 3'b100;
+localparam CMD_PRECHG  = 3'b010;
+localparam CMD_AUTOREF = 3'b001;
+localparam CMD_LMR     = 3'b000;
+
+localparam MAX_CAS = 3;
+
+integer mem;
+initial mem = sim_mem_open("sdram", 32 * 1024 * 1024, 16);
+
+wire [2:0] cmd = {ras_n, cas_n, we_n};
+
+reg [12:0] open_row [0:3];
+reg [3:0]  bank_open;
+reg [2:0]  cas_latency;
+
+// Reads in flight: pipe[i] holds the read registered i edges ago
+reg        rd_pipe_valid [0:MAX_CAS];
+reg [24:0] rd_pipe_addr [0:MAX_CAS];
+
+// Pipe stage that is CL edges old
+wire [1:0] rd_tap = 2'(cas_latency - 3'd1);
+
+reg        dq_oe;
+reg [15:0] dq_out;
+assign dq = dq_oe ? dq_out : 16'bz;
+
+integer i;
+
+initial begin
+    bank_open = 4'b0;
+    cas_latency = 3'd3;
+    dq_oe = 0;
+    for (i = 0; i <= MAX_CAS; i = i + 1) rd_pipe_valid[i] = 0;
+end
+
+always @(posedge clk) begin
+    for (i = MAX_CAS; i > 0; i = i - 1) begin
+        rd_pipe_valid[i] <= rd_pipe_valid[i-1];
+        rd_pipe_addr[i] <= rd_pipe_addr[i-1];
+    end
+    rd_pipe_valid[0] <= 0;
+
+    // Drive the read registered CL edges ago until the next edge
+    dq_oe <= rd_pipe_valid[rd_tap];
+    if (rd_pipe_valid[rd_tap]) begin
+        dq_out <= 16'(sim_mem_read(mem, {7'b0, rd_pipe_addr[rd_tap]}));
+    end
+
+    if (cke) begin
+        case (cmd)
+            CMD_ACT: begin
+                if (bank_open[ba])
+                    $display("sdram_model: ACT to bank %0d with row %0d open", ba, open_row[ba]);
+                bank_open[ba] <= 1;
+                open_row[ba] <= a;
+            end
+            CMD_READ: begin
+                if (!bank_open[ba])
+                    $display("sdram_model: READ from idle bank %0d", ba);
+                rd_pipe_valid[0] <= 1;
+                rd_pipe_addr[0] <= {ba, open_row[ba], a[9:0]};
+            end
+            CMD_WRITE: begin
+                if (!bank_open[ba])
+                    $display("sdram_model: WRITE to idle bank %0d", ba);
+                sim_mem_write(mem, {7'b0, ba, open_row[ba], a[9:0]}, {16'b0, dq}, {30'b0, ~dqm});
+            end
+            CMD_PRECHG: begin
+                if (a[10])
+                    bank_open <= 4'b0;
+                else
+                    bank_open[ba] <= 0;
+            end
+            CMD_AUTOREF: begin
+                if (|bank_open)
+                    $display("sdram_model: AUTO REFRESH with banks %b open", bank_open);
+            end
+            CMD_LMR: begin
+                if (ba == 2'b00) begin
+                    cas_latency <= a[6:4];
+                    if (a[6:4] != 3'd2 && a[6:4] != 3'd3)
+                        $display("sdram_model: unsupported CAS latency %0d", a[6:4]);
+                    if (a[2:0] != 3'b000)
+                        $display("sdram_model: only burst length 1 is modelled");
+                end
+            end
+            default: ;
+        endcase
+    end
+end
+
+endmodule
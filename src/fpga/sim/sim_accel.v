@@ -0,0 +1,67 @@
+//
+// Co-simulation top for the dot product accelerators
+// Puts dma_dot_product and dot8_accel in one Verilator model for
+// tb_accel.cpp, which drives the register ports and plays the io_sdram
+// burst read port.
+//
+
+`default_nettype none
+
+module sim_accel (
+    input wire clk,
+    input wire reset_n,
+
+    // dma_dot_product registers
+    input wire         dma_reg_valid,
+    input wire         dma_reg_write,
+    input wire  [7:0]  dma_reg_addr,
+    input wire  [31:0] dma_reg_wdata,
+    output wire [31:0] dma_reg_rdata,
+
+    // dma_dot_product burst read port
+    output wire        burst_rd,
+    output wire [24:0] burst_addr,
+    output wire [10:0] burst_len,
+    output wire        burst_32bit,
+    input wire  [31:0] burst_data,
+    input wire         burst_data_valid,
+    input wire         burst_data_done,
+
+    // dot8_accel registers
+    input wire         dot8_reg_valid,
+    input wire         dot8_reg_write,
+    input wire  [7:0]  dot8_reg_addr,
+    input wire  [31:0] dot8_reg_wdata,
+    output wire [31:0] dot8_reg_rdata
+);
+
+dma_dot_product dma (
+    .clk(clk),
+    .reset_n(reset_n),
+    .reg_valid(dma_reg_valid),
+    .reg_write(dma_reg_write),
+    .reg_addr(dma_reg_addr),
+    .reg_wdata(dma_reg_wdata),
+    .reg_rdata(dma_reg_rdata),
+    .reg_ready(),
+    .burst_rd(burst_rd),
+    .burst_addr(burst_addr),
+    .burst_len(burst_len),
+    .burst_32bit(burst_32bit),
+    .burst_data(burst_data),
+    .burst_data_valid(burst_data_valid),
+    .burst_data_done(burst_data_done)
+);
+
+dot8_accel dot8 (
+    .clk(clk),
+    .reset_n(reset_n),
+    .reg_valid(dot8_reg_valid),
+    .reg_write(dot8_reg_write),
+    .reg_addr(dot8_reg_addr),
+    .reg_wdata(dot8_reg_wdata),
+    .reg_rdata(dot8_reg_rdata),
+    .reg_ready()
+);
+
+endmodule
@@ -0,0 +1,9 @@
+//
+// DPI storage shared by the simulation memory models (tb_soc.cpp)
+// Memories are opened by name and addressed in words of the given width;
+// mask has one bit per byte lane of the word.
+//
+
+import "DPI-C" function int sim_mem_open(input string name, input int words, input int width);
+import "DPI-C" function int sim_mem_read(input int handle, input int addr);
+import "DPI-C" function void sim_mem_write(input int handle, input int addr, input int data, input int mask);
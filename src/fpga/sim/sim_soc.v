@@ -0,0 +1,445 @@
+//
+// Full-SoC simulation top
+// cpu_system, io_sdram, psram_controller, text_terminal and video_scanout
+// wired as in core_top, with behavioural AS4C32M16 SDRAM and CellularRAM
+// chips on the pins and sdram_checker watching the SDRAM bus. tb_soc.cpp drives the clocks and reset, loads the
+// firmware into the memories (through altsyncram.v and the DPI storage)
+// and watches the retire port for the halt marker.
+//
+// Left out: the APF bridge and data slots (the SDRAM image is preloaded,
+// so dataslot_allcomplete is tied high), PLLs (tb_soc.cpp generates
+// clk_sys and clk_video) and audio.
+//
+
+`default_nettype none
+
+module sim_soc #(
+    parameter SDRAM_ADDR_MAP = 2    // io_sdram ADDR_MAP, as core_top
+) (
+    input wire clk_sys,         // 133.12 MHz: CPU, SDRAM and PSRAM controllers
+    input wire clk_video,       // 12.288 MHz pixel clock
+    input wire reset_n,
+
+    // Instruction retire, for halt/marker detection
+    output wire        retire_valid,
+    output wire [31:0] retire_pc,
+    output wire [31:0] retire_insn,
+
+    // SDRAM protocol/timing violations seen by sdram_checker
+    output wire [31:0] sdram_violations,
+
+    // Video output (as core_top drives the scaler)
+    output reg  [23:0] vid_rgb,
+    output reg         vid_de,
+    output reg         vid_vs,
+    output reg         vid_hs
+);
+
+// ============================================
+// CPU
+// ============================================
+
+wire        term_mem_valid;
+wire [31:0] term_mem_addr;
+wire [31:0] term_mem_wdata;
+wire [3:0]  term_mem_wstrb;
+wire [31:0] term_mem_rdata;
+wire        term_mem_ready;
+
+wire        cpu_sdram_rd;
+wire        cpu_sdram_wr;
+wire [23:0] cpu_sdram_addr;
+wire [31:0] cpu_sdram_wdata;
+wire [3:0]  cpu_sdram_wstrb;
+wire [1:0]  cpu_sdram_tag;
+wire [31:0] cpu_sdram_rdata;
+wire        cpu_sdram_ready;
+wire        cpu_sdram_rdata_valid;
+wire [1:0]  cpu_sdram_rdata_tag;
+wire        cpu_sdram_stat_snapshot;
+wire        cpu_sdram_stat_clear;
+wire [415:0] sdram_stats;
+
+wire        cpu_psram_rd;
+wire        cpu_psram_wr;
+wire [21:0] cpu_psram_addr;
+wire [31:0] cpu_psram_wdata;
+wire [31:0] cpu_psram_rdata;
+wire        cpu_psram_busy;
+wire        cpu_psram_rdata_valid;
+
+wire        display_mode;
+wire [24:0] fb_display_addr;
+
+cpu_system cpu (
+    .clk(clk_sys),
+    .clk_74a(clk_sys),
+    .reset_n(reset_n),
+    .dataslot_allcomplete(1'b1),
+    .vsync(vid_vs),
+    .term_mem_valid(term_mem_valid),
+    .term_mem_addr(term_mem_addr),
+    .term_mem_wdata(term_mem_wdata),
+    .term_mem_wstrb(term_mem_wstrb),
+    .term_mem_rdata(term_mem_rdata),
+    .term_mem_ready(term_mem_ready),
+    .sdram_rd(cpu_sdram_rd),
+    .sdram_wr(cpu_sdram_wr),
+    .sdram_addr(cpu_sdram_addr),
+    .sdram_wdata(cpu_sdram_wdata),
+    .sdram_wstrb(cpu_sdram_wstrb),
+    .sdram_tag(cpu_sdram_tag),
+    .sdram_rdata(cpu_sdram_rdata),
+    .sdram_ready(cpu_sdram_ready),
+    .sdram_rdata_valid(cpu_sdram_rdata_valid),
+    .sdram_rdata_tag(cpu_sdram_rdata_tag),
+    .sdram_stat_snapshot(cpu_sdram_stat_snapshot),
+    .sdram_stat_clear(cpu_sdram_stat_clear),
+    .sdram_stats(sdram_stats),
+    .psram_rd(cpu_psram_rd),
+    .psram_wr(cpu_psram_wr),
+    .psram_addr(cpu_psram_addr),
+    .psram_wdata(cpu_psram_wdata),
+    .psram_rdata(cpu_psram_rdata),
+    .psram_busy(cpu_psram_busy),
+    .psram_rdata_valid(cpu_psram_rdata_valid),
+    .display_mode(display_mode),
+    .fb_display_addr(fb_display_addr)
+);
+
+assign retire_valid = cpu.cpu.writeBack_arbitration_isFiring;
+assign retire_pc = cpu.cpu.writeBack_PC;
+assign retire_insn = cpu.cpu.writeBack_INSTRUCTION;
+
+// CPU SDRAM access latency: cycles from request to ack, per access.
+// Instruction and data reads are counted separately since both can be
+// in flight; overlapped cycles have one of each.
+reg [63:0] sdram_reads, sdram_read_cycles, sdram_read_overlap, sdram_read_chained;
+reg [63:0] sdram_writes, sdram_write_cycles;
+reg [63:0] sdram_refreshes, sdram_refreshes_urgent;
+wire       sdram_refresh_urgent;
+reg        sdram_ibus_was_pending, sdram_dbus_was_pending, sdram_write_was_pending;
+
+initial begin
+    sdram_reads = 0;
+    sdram_read_cycles = 0;
+    sdram_read_overlap = 0;
+    sdram_read_chained = 0;
+    sdram_writes = 0;
+    sdram_write_cycles = 0;
+    sdram_refreshes = 0;
+    sdram_refreshes_urgent = 0;
+end
+
+always @(posedge clk_sys) begin
+    sdram_ibus_was_pending <= cpu.sdram_read_ibus;
+    sdram_dbus_was_pending <= cpu.sdram_read_dbus;
+    sdram_write_was_pending <= cpu.sdram_write_pending;
+    sdram_read_cycles <= sdram_read_cycles + {63'b0, cpu.sdram_read_ibus} +
+                         {63'b0, cpu.sdram_read_dbus};
+    sdram_reads <= sdram_reads + {63'b0, cpu.sdram_read_ibus && !sdram_ibus_was_pending} +
+                   {63'b0, cpu.sdram_read_dbus && !sdram_dbus_was_pending};
+    if (cpu.sdram_read_ibus && cpu.sdram_read_dbus)
+        sdram_read_overlap <= sdram_read_overlap + 1;
+    if (isr0.sync_word_chain)
+        sdram_read_chained <= sdram_read_chained + 1;
+    if (isr0.state == isr0.ST_REFRESH_0) begin
+        sdram_refreshes <= sdram_refreshes + 1;
+        if (sdram_refresh_urgent) sdram_refreshes_urgent <= sdram_refreshes_urgent + 1;
+    end
+    if (cpu.sdram_write_pending) begin
+        sdram_write_cycles <= sdram_write_cycles + 1;
+        if (!sdram_write_was_pending) sdram_writes <= sdram_writes + 1;
+    end
+end
+
+final begin
+    if (sdram_reads != 0)
+        $display("cpu sdram: %0d reads, %0d.%0d cycles each, %0d cycles with two in flight",
+                 sdram_reads, sdram_read_cycles / sdram_reads,
+                 (sdram_read_cycles * 10 / sdram_reads) % 10, sdram_read_overlap);
+    if (sdram_read_chained != 0)
+        $display("cpu sdram: %0d reads chained into an open row", sdram_read_chained);
+    if (sdram_writes != 0)
+        $display("cpu sdram: %0d writes, %0d.%0d cycles each", sdram_writes,
+                 sdram_write_cycles / sdram_writes, (sdram_write_cycles * 10 / sdram_writes) % 10);
+    if (sdram_refreshes != 0)
+        $display("sdram: %0d refreshes, %0d forced by refresh debt", sdram_refreshes,
+                 sdram_refreshes_urgent);
+end
+
+// ============================================
+// SDRAM
+// ============================================
+
+wire        dram_cke;
+wire        dram_clk;
+wire        dram_ras_n;
+wire        dram_cas_n;
+wire        dram_we_n;
+wire [1:0]  dram_ba;
+wire [12:0] dram_a;
+wire [15:0] dram_dq;
+wire [1:0]  dram_dqm;
+
+wire        video_burst_rd;
+wire [24:0] video_burst_addr;
+wire [10:0] video_burst_len;
+wire        video_burst_32bit;
+wire [31:0] video_burst_data;
+wire        video_burst_data_valid;
+wire        video_burst_data_done;
+
+io_sdram #(.ADDR_MAP(SDRAM_ADDR_MAP)) isr0 (
+    .controller_clk(clk_sys),
+    .chip_clk(clk_sys),
+    .clk_90(clk_sys),
+    .reset_n(1'b1),
+
+    .phy_cke(dram_cke),
+    .phy_clk(dram_clk),
+    .phy_cas(dram_cas_n),
+    .phy_ras(dram_ras_n),
+    .phy_we(dram_we_n),
+    .phy_ba(dram_ba),
+    .phy_a(dram_a),
+    .phy_dq(dram_dq),
+    .phy_dqm(dram_dqm),
+
+    .burst_rd(video_burst_rd),
+    .burst_addr(video_burst_addr),
+    .burst_len(video_burst_len),
+    .burst_32bit(video_burst_32bit),
+    .burst_data(video_burst_data),
+    .burst_data_valid(video_burst_data_valid),
+    .burst_data_done(video_burst_data_done),
+
+    .burstwr(1'b0),
+    .burstwr_addr(25'b0),
+    .burstwr_ready(),
+    .burstwr_strobe(1'b0),
+    .burstwr_data(16'b0),
+    .burstwr_done(1'b0),
+
+    .word_rd(1'b0),
+    .word_wr(1'b0),
+    .word_addr(24'b0),
+    .word_data(32'b0),
+    .word_q(cpu_sdram_rdata),
+    .word_busy(),
+    .word_q_valid(),
+
+    .sync_word_valid(cpu_sdram_rd | cpu_sdram_wr),
+    .sync_word_wr(cpu_sdram_wr),
+    .sync_word_addr(cpu_sdram_addr),
+    .sync_word_data(cpu_sdram_wdata),
+    .sync_word_tag(cpu_sdram_tag),
+    .sync_word_mask(cpu_sdram_wstrb),
+    .sync_word_ready(cpu_sdram_ready),
+    .sync_word_q_valid(cpu_sdram_rdata_valid),
+    .sync_word_q_tag(cpu_sdram_rdata_tag),
+
+    .refresh_urgent(sdram_refresh_urgent),
+
+    .stat_snapshot(cpu_sdram_stat_snapshot),
+    .stat_clear(cpu_sdram_stat_clear),
+    .stats(sdram_stats)
+);
+
+// Request trace for dram_sched (tb_soc.cpp --sdram-trace): one call per
+// request io_sdram accepts, with its 16-bit-word address and beat count
+import "DPI-C" function void sim_sdram_request(input int source, input int write,
+                                               input int addr, input int beats);
+
+localparam TRACE_CPU = 0;
+localparam TRACE_VIDEO = 1;
+
+always @(posedge clk_sys) begin
+    if ((cpu_sdram_rd | cpu_sdram_wr) && cpu_sdram_ready)
+        sim_sdram_request(TRACE_CPU, {31'b0, cpu_sdram_wr}, {7'b0, cpu_sdram_addr, 1'b0}, 2);
+    if (video_burst_rd)
+        sim_sdram_request(TRACE_VIDEO, 0, {7'b0, video_burst_addr}, {21'b0, video_burst_len});
+end
+
+sdram_model sdram (
+    .clk(dram_clk),
+    .cke(dram_cke),
+    .ras_n(dram_ras_n),
+    .cas_n(dram_cas_n),
+    .we_n(dram_we_n),
+    .ba(dram_ba),
+    .a(dram_a),
+    .dq(dram_dq),
+    .dqm(dram_dqm)
+);
+
+sdram_checker sdram_check (
+    .clk(dram_clk),
+    .cke(dram_cke),
+    .ras_n(dram_ras_n),
+    .cas_n(dram_cas_n),
+    .we_n(dram_we_n),
+    .ba(dram_ba),
+    .a(dram_a),
+    .violations(sdram_violations)
+);
+
+// ============================================
+// PSRAM (cram0)
+// ============================================
+
+wire [21:16] cram0_a;
+wire [15:0]  cram0_dq;
+wire         cram0_clk;
+wire         cram0_adv_n;
+wire         cram0_cre;
+wire         cram0_ce0_n;
+wire         cram0_ce1_n;
+wire         cram0_oe_n;
+wire         cram0_we_n;
+wire         cram0_ub_n;
+wire         cram0_lb_n;
+
+psram_controller #(
+    .CLOCK_SPEED(133.12)
+) psram0 (
+    .clk(clk_sys),
+    .reset_n(reset_n),
+
+    .word_rd(cpu_psram_rd),
+    .word_wr(cpu_psram_wr),
+    .word_addr(cpu_psram_addr),
+    .word_data(cpu_psram_wdata),
+    .word_q(cpu_psram_rdata),
+    .word_busy(cpu_psram_busy),
+    .word_q_valid(cpu_psram_rdata_valid),
+
+    .cram_a(cram0_a),
+    .cram_dq(cram0_dq),
+    .cram_wait(1'b0),
+    .cram_clk(cram0_clk),
+    .cram_adv_n(cram0_adv_n),
+    .cram_cre(cram0_cre),
+    .cram_ce0_n(cram0_ce0_n),
+    .cram_ce1_n(cram0_ce1_n),
+    .cram_oe_n(cram0_oe_n),
+    .cram_we_n(cram0_we_n),
+    .cram_ub_n(cram0_ub_n),
+    .cram_lb_n(cram0_lb_n)
+);
+
+cellularram_model cram0 (
+    .clk(clk_sys),
+    .a(cram0_a),
+    .dq(cram0_dq),
+    .adv_n(cram0_adv_n),
+    .ce0_n(cram0_ce0_n),
+    .ce1_n(cram0_ce1_n),
+    .oe_n(cram0_oe_n),
+    .we_n(cram0_we_n),
+    .ub_n(cram0_ub_n),
+    .lb_n(cram0_lb_n)
+);
+
+// ============================================
+// Video (timing and mux as core_top)
+// ============================================
+
+localparam  VID_V_BPORCH = 'd16;
+localparam  VID_V_ACTIVE = 'd240;
+localparam  VID_V_TOTAL = 'd512;
+localparam  VID_H_BPORCH = 'd40;
+localparam  VID_H_ACTIVE = 'd320;
+localparam  VID_H_TOTAL = 'd400;
+
+reg [9:0]   x_count;
+reg [9:0]   y_count;
+
+wire [9:0]  visible_x = x_count - VID_H_BPORCH;
+wire [9:0]  visible_y = y_count - VID_V_BPORCH;
+
+wire [23:0] terminal_pixel_color;
+
+text_terminal terminal (
+    .clk(clk_video),
+    .clk_cpu(clk_sys),
+    .reset_n(reset_n),
+    .pixel_x(visible_x),
+    .pixel_y(visible_y),
+    .pixel_color(terminal_pixel_color),
+    .mem_valid(term_mem_valid),
+    .mem_addr(term_mem_addr),
+    .mem_wdata(term_mem_wdata),
+    .mem_wstrb(term_mem_wstrb),
+    .mem_rdata(term_mem_rdata),
+    .mem_ready(term_mem_ready)
+);
+
+reg line_start;
+always @(posedge clk_video) begin
+    line_start <= (x_count == 0);
+end
+
+wire [23:0] framebuffer_pixel_color;
+
+video_scanout scanout (
+    .clk_video(clk_video),
+    .reset_n(reset_n),
+    .x_count(x_count),
+    .y_count(y_count),
+    .line_start(line_start),
+    .pixel_color(framebuffer_pixel_color),
+    .fb_base_addr(fb_display_addr),
+    .clk_sdram(clk_sys),
+    .burst_rd(video_burst_rd),
+    .burst_addr(video_burst_addr),
+    .burst_len(video_burst_len),
+    .burst_32bit(video_burst_32bit),
+    .burst_data(video_burst_data),
+    .burst_data_valid(video_burst_data_valid),
+    .burst_data_done(video_burst_data_done)
+);
+
+always @(posedge clk_video or negedge reset_n) begin
+    if (~reset_n) begin
+        x_count <= 0;
+        y_count <= 0;
+        vid_de <= 0;
+        vid_vs <= 0;
+        vid_hs <= 0;
+        vid_rgb <= 0;
+    end else begin
+        vid_de <= 0;
+        vid_vs <= 0;
+        vid_hs <= 0;
+
+        x_count <= x_count + 1'b1;
+        if (x_count == VID_H_TOTAL-1) begin
+            x_count <= 0;
+            y_count <= y_count + 1'b1;
+            if (y_count == VID_V_TOTAL-1) begin
+                y_count <= 0;
+            end
+        end
+
+        if (x_count == 0 && y_count == 0) begin
+            vid_vs <= 1;
+        end
+        if (x_count == 3) begin
+            vid_hs <= 1;
+        end
+
+        vid_rgb <= 24'h0;
+        if (x_count >= VID_H_BPORCH && x_count < VID_H_ACTIVE+VID_H_BPORCH &&
+            y_count >= VID_V_BPORCH && y_count < VID_V_ACTIVE+VID_V_BPORCH) begin
+            vid_de <= 1;
+            // 0=terminal overlay, 1=framebuffer only
+            if (!display_mode && terminal_pixel_color == 24'hFFFFFF)
+                vid_rgb <= terminal_pixel_color;
+            else
+                vid_rgb <= framebuffer_pixel_color;
+        end
+    end
+end
+
+endmodule
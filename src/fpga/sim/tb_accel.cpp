@@ -0,0 +1,387 @@
+//
+// RTL vs reference co-simulation of the dot product accelerators
+//
+// Runs random vectors and lengths through every dma_dot_product mode
+// (normal, preload/cached B, pipelined, weight cache, streaming, Q4) and
+// through dot8_accel, and checks each 64-bit result for equality with
+// accel_ref.c. The SDRAM side is a behavioural io_sdram burst port:
+// one pending request, a few cycles of latency, a 32-bit word at most
+// every other cycle with random stalls, and burst_data_done a few cycles
+// after the last word.
+//
+// Usage: Vsim_accel [seed] [trials]
+//
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "Vsim_accel.h"
+#include "verilated.h"
+
+#include "accel_ref.h"
+
+// dma_dot_product registers
+enum {
+    DMA_CTRL = 0x00,
+    DMA_LENGTH = 0x04,
+    DMA_RESULT_LO = 0x08,
+    DMA_RESULT_HI = 0x0C,
+    DMA_ADDR_A = 0x10,
+    DMA_ADDR_B = 0x14,
+    DMA_ADDR_A_NEXT = 0x18,
+    DMA_CACHE_CTRL = 0x20,
+    DMA_CACHE_ADDR = 0x28,
+    DMA_CACHE_LEN = 0x2C,
+    DMA_CACHE_ROW_OFFSET = 0x30,
+};
+
+enum {
+    CTRL_START = 1 << 0,
+    CTRL_CACHED_B = 1 << 1,
+    CTRL_PRELOAD_B = 1 << 2,
+    CTRL_PIPELINE = 1 << 3,
+    CTRL_WEIGHT_CACHE = 1 << 4,
+    CTRL_STREAMING = 1 << 5,
+    CTRL_Q4 = 1 << 6,
+};
+
+// dot8_accel registers
+enum {
+    DOT8_A_DATA = 0x00,
+    DOT8_B_DATA = 0x04,
+    DOT8_CTRL = 0x08,
+    DOT8_RESULT_LO = 0x0C,
+    DOT8_RESULT_HI = 0x10,
+};
+
+static const uint32_t MEM_WORDS = 1 << 20;  // 4MB of the 64MB SDRAM
+static const uint64_t TIMEOUT_CYCLES = 200000;
+
+static std::mt19937 rng;
+
+static uint32_t rand_below(uint32_t n) {
+    return std::uniform_int_distribution<uint32_t>(0, n - 1)(rng);
+}
+
+// Behavioural io_sdram burst read port, 32-bit mode
+struct SdramModel {
+    std::vector<uint32_t> mem = std::vector<uint32_t>(MEM_WORDS);
+    bool pending = false;           // io_sdram queues one request
+    uint32_t pending_addr = 0, pending_words = 0;
+    bool active = false;
+    uint32_t addr = 0, words_left = 0;
+    int wait = 0;                   // Cycles until the next word/done
+
+    void request(uint32_t burst_addr, uint32_t burst_len) {
+        pending = true;
+        pending_addr = burst_addr >> 1;
+        pending_words = burst_len >> 1;
+    }
+
+    // One clock: returns the port outputs for the next cycle
+    void tick(uint32_t &data, bool &valid, bool &done) {
+        valid = false;
+        done = false;
+        if (!active && pending) {
+            pending = false;
+            active = true;
+            addr = pending_addr;
+            words_left = pending_words;
+            wait = 8 + rand_below(4);   // ACT + tRCD + CAS
+        }
+        if (!active || --wait > 0) return;
+
+        if (words_left > 0) {
+            data = mem[addr++ % MEM_WORDS];
+            valid = true;
+            words_left--;
+            // Two 16-bit beats per word, occasionally a row change
+            wait = 2 + (rand_below(16) == 0 ? 4 + rand_below(6) : 0);
+            if (words_left == 0) wait = 3;
+        } else {
+            done = true;
+            active = false;
+        }
+    }
+};
+
+struct Bench {
+    std::unique_ptr<VerilatedContext> ctx;
+    std::unique_ptr<Vsim_accel> top;
+    SdramModel sdram;
+    uint64_t cycles = 0;
+    int failures = 0;
+    int checks = 0;
+
+    Bench() : ctx(new VerilatedContext), top(new Vsim_accel(ctx.get())) {
+        top->reset_n = 0;
+        for (int i = 0; i < 4; i++) step();
+        top->reset_n = 1;
+        step();
+    }
+
+    void step() {
+        top->clk = 1;
+        top->eval();
+        if (top->burst_rd) sdram.request(top->burst_addr, top->burst_len);
+        uint32_t data = top->burst_data;
+        bool valid, done;
+        sdram.tick(data, valid, done);
+        top->burst_data = data;
+        top->burst_data_valid = valid;
+        top->burst_data_done = done;
+        top->clk = 0;
+        top->eval();
+        cycles++;
+    }
+
+    void dma_write(uint8_t reg, uint32_t value) {
+        top->dma_reg_valid = 1;
+        top->dma_reg_write = 1;
+        top->dma_reg_addr = reg;
+        top->dma_reg_wdata = value;
+        step();
+        top->dma_reg_valid = 0;
+        top->dma_reg_write = 0;
+        step();
+    }
+
+    uint32_t dma_read(uint8_t reg) {
+        top->dma_reg_addr = reg;
+        top->eval();
+        return top->dma_reg_rdata;
+    }
+
+    void dot8_write(uint8_t reg, uint32_t value) {
+        top->dot8_reg_valid = 1;
+        top->dot8_reg_write = 1;
+        top->dot8_reg_addr = reg;
+        top->dot8_reg_wdata = value;
+        step();
+        top->dot8_reg_valid = 0;
+        top->dot8_reg_write = 0;
+        step();
+    }
+
+    uint32_t dot8_read(uint8_t reg) {
+        top->dot8_reg_addr = reg;
+        top->eval();
+        return top->dot8_reg_rdata;
+    }
+
+    void wait_while(uint8_t reg, uint32_t mask, const char *what) {
+        uint64_t start = cycles;
+        while (dma_read(reg) & mask) {
+            step();
+            if (cycles - start > TIMEOUT_CYCLES) {
+                std::printf("FAIL %s: timeout\n", what);
+                std::exit(1);
+            }
+        }
+        // Let the controller drain any trailing done pulse
+        while (sdram.active || sdram.pending) step();
+    }
+
+    int64_t dma_run(uint32_t ctrl, const char *what) {
+        dma_write(DMA_CTRL, ctrl);
+        wait_while(DMA_CTRL, 1, what);
+        return (int64_t)(((uint64_t)dma_read(DMA_RESULT_HI) << 32) | dma_read(DMA_RESULT_LO));
+    }
+
+    void check(const char *what, uint32_t n, int64_t got, int64_t expected) {
+        checks++;
+        if (got != expected) {
+            failures++;
+            std::printf("FAIL %-14s n=%3u got %016llx expected %016llx\n", what, n,
+                        (unsigned long long)got, (unsigned long long)expected);
+        }
+    }
+};
+
+// Random Q16.16 vector: full int32 range (exercises wrap) or realistic
+static void fill_vector(SdramModel &sdram, uint32_t addr, uint32_t n) {
+    bool full = rand_below(2);
+    for (uint32_t i = 0; i < n; i++) {
+        sdram.mem[addr + i] = full ? (uint32_t)rng() : (uint32_t)(int32_t)(rand_below(1 << 20) - (1 << 19));
+    }
+}
+
+static void fill_q4(SdramModel &sdram, uint32_t addr, uint32_t n) {
+    for (uint32_t w = 0; w < n / ACCEL_REF_Q4_BLOCK * ACCEL_REF_Q4_WORDS; w++) {
+        sdram.mem[addr + w] = (w % ACCEL_REF_Q4_WORDS == 0) ? (uint32_t)(int32_t)(rand_below(1 << 16) - (1 << 15))
+                                                             : (uint32_t)rng();
+    }
+}
+
+static const int32_t *vec(SdramModel &sdram, uint32_t addr) {
+    return (const int32_t *)&sdram.mem[addr];
+}
+
+// Distinct, non-overlapping vector slots
+static uint32_t slot(int i) {
+    return 0x1000 + i * 0x1000;
+}
+
+// Any length, odd ones included; the full buffer one time in eight
+static uint32_t vec_length() {
+    if (rand_below(8) == 0) return ACCEL_REF_MAX_LENGTH;
+    return 1 + rand_below(ACCEL_REF_MAX_LENGTH);
+}
+
+static uint32_t q4_length() {
+    if (rand_below(8) == 0) return ACCEL_REF_MAX_LENGTH;
+    return ACCEL_REF_Q4_BLOCK * (1 + rand_below(ACCEL_REF_MAX_LENGTH / ACCEL_REF_Q4_BLOCK));
+}
+
+static void test_normal(Bench &tb) {
+    uint32_t n = vec_length();
+    fill_vector(tb.sdram, slot(0), n);
+    fill_vector(tb.sdram, slot(1), n);
+    tb.dma_write(DMA_LENGTH, n);
+    tb.dma_write(DMA_ADDR_A, slot(0));
+    tb.dma_write(DMA_ADDR_B, slot(1));
+    tb.check("normal", n, tb.dma_run(CTRL_START, "normal"),
+             accel_ref_dot(vec(tb.sdram, slot(0)), vec(tb.sdram, slot(1)), n));
+}
+
+static void preload_b(Bench &tb, uint32_t n) {
+    fill_vector(tb.sdram, slot(1), n);
+    tb.dma_write(DMA_LENGTH, n);
+    tb.dma_write(DMA_ADDR_B, slot(1));
+    tb.dma_run(CTRL_START | CTRL_PRELOAD_B, "preload");
+}
+
+static void test_cached_b(Bench &tb) {
+    uint32_t n = vec_length();
+    preload_b(tb, n);
+    for (int i = 0; i < 3; i++) {
+        fill_vector(tb.sdram, slot(2 + i), n);
+        tb.dma_write(DMA_ADDR_A, slot(2 + i));
+        tb.check("cached_b", n, tb.dma_run(CTRL_START | CTRL_CACHED_B, "cached_b"),
+                 accel_ref_dot(vec(tb.sdram, slot(2 + i)), vec(tb.sdram, slot(1)), n));
+    }
+}
+
+// Chain: each start computes the previous A while prefetching the next
+static void run_pipeline(Bench &tb, uint32_t n, bool q4, const char *what) {
+    int count = 2 + rand_below(4);
+    uint32_t mode = q4 ? CTRL_Q4 : 0;
+    preload_b(tb, n);
+    for (int i = 0; i < count; i++) {
+        if (q4)
+            fill_q4(tb.sdram, slot(2 + i), n);
+        else
+            fill_vector(tb.sdram, slot(2 + i), n);
+    }
+    tb.dma_write(DMA_ADDR_A, slot(2));
+    for (int i = 0; i < count; i++) {
+        uint32_t ctrl = CTRL_START | CTRL_CACHED_B | mode;
+        if (i + 1 < count) {
+            tb.dma_write(DMA_ADDR_A_NEXT, slot(3 + i));
+            ctrl |= CTRL_PIPELINE;
+        }
+        const int32_t *b = vec(tb.sdram, slot(1));
+        int64_t expected = q4 ? accel_ref_dot_q4(&tb.sdram.mem[slot(2 + i)], b, n)
+                              : accel_ref_dot(vec(tb.sdram, slot(2 + i)), b, n);
+        tb.check(what, n, tb.dma_run(ctrl, what), expected);
+    }
+}
+
+static void test_pipeline(Bench &tb) {
+    run_pipeline(tb, vec_length(), false, "pipeline");
+}
+
+static void test_weight_cache(Bench &tb, std::vector<int32_t> &cache) {
+    uint32_t load = 1 + rand_below(ACCEL_REF_CACHE_SIZE - 1);
+    fill_vector(tb.sdram, slot(8), load);
+    tb.dma_write(DMA_CACHE_ADDR, slot(8));
+    tb.dma_write(DMA_CACHE_LEN, load);
+    tb.dma_write(DMA_CACHE_CTRL, 1 << 8);
+    tb.wait_while(DMA_CACHE_CTRL, 1 << 4, "cache load");
+    for (uint32_t i = 0; i < load; i++) cache[i] = (int32_t)tb.sdram.mem[slot(8) + i];
+
+    for (int i = 0; i < 3; i++) {
+        uint32_t n = vec_length();
+        uint32_t row_offset = rand_below(ACCEL_REF_CACHE_SIZE);
+        fill_vector(tb.sdram, slot(1), n);
+        tb.dma_write(DMA_LENGTH, n);
+        tb.dma_write(DMA_ADDR_B, slot(1));
+        tb.dma_write(DMA_CACHE_ROW_OFFSET, row_offset);
+        // Alternate fetching B and reusing the B just fetched
+        uint32_t ctrl = CTRL_START | CTRL_WEIGHT_CACHE;
+        tb.check("cache", n, tb.dma_run(ctrl, "cache"),
+                 accel_ref_dot_cache(cache.data(), row_offset, vec(tb.sdram, slot(1)), n));
+        tb.check("cache_cached_b", n, tb.dma_run(ctrl | CTRL_CACHED_B, "cache_cached_b"),
+                 accel_ref_dot_cache(cache.data(), row_offset, vec(tb.sdram, slot(1)), n));
+    }
+}
+
+static void test_streaming(Bench &tb) {
+    uint32_t n = vec_length();
+    preload_b(tb, n);
+    fill_vector(tb.sdram, slot(2), n);
+    tb.dma_write(DMA_ADDR_A, slot(2));
+    tb.check("streaming", n, tb.dma_run(CTRL_START | CTRL_CACHED_B | CTRL_STREAMING, "streaming"),
+             accel_ref_dot(vec(tb.sdram, slot(2)), vec(tb.sdram, slot(1)), n));
+}
+
+static void test_q4(Bench &tb) {
+    uint32_t n = q4_length();
+    fill_q4(tb.sdram, slot(0), n);
+    fill_vector(tb.sdram, slot(1), n);
+    tb.dma_write(DMA_LENGTH, n);
+    tb.dma_write(DMA_ADDR_A, slot(0));
+    tb.dma_write(DMA_ADDR_B, slot(1));
+    tb.check("q4", n, tb.dma_run(CTRL_START | CTRL_Q4, "q4"),
+             accel_ref_dot_q4(&tb.sdram.mem[slot(0)], vec(tb.sdram, slot(1)), n));
+    // Q4 masks the streaming bit: still the buffered Q4 result
+    tb.check("q4_streaming_bit", n, tb.dma_run(CTRL_START | CTRL_Q4 | CTRL_STREAMING, "q4_streaming_bit"),
+             accel_ref_dot_q4(&tb.sdram.mem[slot(0)], vec(tb.sdram, slot(1)), n));
+    run_pipeline(tb, q4_length(), true, "q4_pipeline");
+}
+
+static void test_dot8(Bench &tb) {
+    int32_t a[8], b[8];
+    tb.dot8_write(DOT8_CTRL, 1 << 1);  // Reset indices
+    for (int i = 0; i < 8; i++) {
+        a[i] = (int32_t)rng();
+        tb.dot8_write(DOT8_A_DATA, (uint32_t)a[i]);
+    }
+    // Several B vectors against the same A
+    for (int k = 0; k < 3; k++) {
+        for (int i = 0; i < 8; i++) {
+            b[i] = (int32_t)rng();
+            tb.dot8_write(DOT8_B_DATA, (uint32_t)b[i]);
+        }
+        while (tb.dot8_read(DOT8_CTRL) & 1) tb.step();
+        int64_t got = (int64_t)(((uint64_t)tb.dot8_read(DOT8_RESULT_HI) << 32) | tb.dot8_read(DOT8_RESULT_LO));
+        tb.check("dot8", 8, got, accel_ref_dot8(a, b));
+    }
+}
+
+int main(int argc, char **argv) {
+    uint32_t seed = argc > 1 ? strtoul(argv[1], nullptr, 0) : 1;
+    int trials = argc > 2 ? atoi(argv[2]) : 50;
+    rng.seed(seed);
+
+    Bench tb;
+    std::vector<int32_t> cache(ACCEL_REF_CACHE_SIZE);
+    for (int t = 0; t < trials; t++) {
+        test_normal(tb);
+        test_cached_b(tb);
+        test_pipeline(tb);
+        test_weight_cache(tb, cache);
+        test_streaming(tb);
+        test_q4(tb);
+        test_dot8(tb);
+    }
+
+    std::printf("%s: %d/%d checks passed (seed %u, %llu cycles)\n",
+                tb.failures ? "FAIL" : "PASS", tb.checks - tb.failures, tb.checks,
+                seed, (unsigned long long)tb.cycles);
+    return tb.failures ? 1 : 0;
+}
@@ -0,0 +1,684 @@
+//
+// Full-SoC simulation: runs firmware on cpu_system + io_sdram +
+// psram_controller + text_terminal + video_scanout (sim_soc.v)
+//
+// Loads the firmware into the memories the way the Pocket does - BRAM
+// from the altsyncram init image, the SDRAM image as the data slot would
+// - releases reset once io_sdram has finished its boot sequence, and runs
+// until the CPU halts (retires "j ." as crt0's halt loop and pgo_dump.c
+// do) or the instruction at --until retires. Prints the text terminal
+// and the cycle count since reset; this is the firmware Makefile's FW_RUN
+// runner, including the PGO_STREAM profile dump, and prints the
+// perf_results block of the perf firmware variant (perf.c) when present.
+// sdram_checker's bus statistics follow; any SDRAM protocol or timing
+// violation fails the run.
+//
+// With --capture the scaler-side video (vid_rgb/vid_de/vid_vs) is written
+// out as PNG frames, and the number of frames whose contents changed is
+// reported per simulated second - the firmware's effective frame rate.
+//
+// Usage: Vsim_soc [options] firmware.elf | firmware.bin
+//   --sdram FILE      SDRAM image for a .bin (loaded at 0x10300000, as data.json)
+//   --until SYMBOL    stop when the instruction at SYMBOL retires (ELF only)
+//   --max-cycles N    give up after N CPU cycles (default 1000000000)
+//   --capture DIR     write video frames to DIR/frame_NNNN.png
+//   --every N         capture every Nth frame (default 1)
+//   --frames N        stop after capturing N frames
+//   --sdram-trace FILE  log every request io_sdram accepts, for dram_sched
+//   -q                do not print the terminal
+//
+
+#include <elf.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <zlib.h>
+
+#include "Vsim_soc.h"
+#include "Vsim_soc__Dpi.h"
+#include "verilated.h"
+
+#ifndef FPGA_DIR
+#define FPGA_DIR ".."
+#endif
+
+// io_sdram ADDR_MAP the harness was built with (sim_soc.v SDRAM_ADDR_MAP)
+#ifndef SDRAM_ADDR_MAP
+#define SDRAM_ADDR_MAP 2
+#endif
+
+// Memory map (cpu_system.v)
+static const uint32_t BRAM_BASE = 0x00000000, BRAM_BYTES = 64 * 1024;
+static const uint32_t SDRAM_BASE = 0x10000000, SDRAM_BYTES = 64 * 1024 * 1024;
+static const uint32_t PSRAM_BASE = 0x30000000, PSRAM_BYTES = 16 * 1024 * 1024;
+static const uint32_t SDRAM_IMAGE = 0x10300000;  // data.json slot address
+
+static const uint32_t INSN_HALT = 0x0000006F;    // jal x0, 0 ("j .")
+static const uint32_t INSN_NOP = 0x00000013;     // MIF fill for unused BRAM
+
+static const uint64_t SYS_HALF_PS = 3756;        // 133.12 MHz
+static const uint64_t VIDEO_HALF_PS = 40690;     // 12.288 MHz
+static const uint64_t RESET_CYCLES = 32768;      // io_sdram boot takes 30000
+
+static const int TERM_COLS = 40, TERM_ROWS = 30;
+static const int VIDEO_W = 320, VIDEO_H = 240;   // core_top active area
+
+// ============================================
+// DPI memories (sim_mem.vh)
+// ============================================
+
+struct SimMem {
+    std::string name;
+    uint32_t words;
+    uint32_t width;
+    uint32_t *data;
+};
+
+static std::vector<std::unique_ptr<SimMem>> mems;
+
+static uint32_t width_mask(uint32_t width) {
+    return width >= 32 ? 0xFFFFFFFFu : (1u << width) - 1;
+}
+
+static bool load_mif(SimMem &m, const std::string &path);
+
+static int mem_find(const std::string &name) {
+    for (size_t i = 0; i < mems.size(); i++) {
+        if (mems[i]->name == name) return (int)i;
+    }
+    return -1;
+}
+
+static int mem_get(const std::string &name, uint32_t words, uint32_t width) {
+    int handle = mem_find(name);
+    if (handle >= 0) return handle;
+    // calloc: the 64MB SDRAM only costs the pages that are touched
+    mems.emplace_back(new SimMem{name, words, width, (uint32_t *)std::calloc(words, sizeof(uint32_t))});
+    return (int)mems.size() - 1;
+}
+
+int sim_mem_open(const char *name, int words, int width) {
+    bool fresh = mem_find(name) < 0;
+    int handle = mem_get(name, words, width);
+    if (fresh && std::strchr(name, '.')) {
+        load_mif(*mems[handle], std::string(FPGA_DIR) + "/" + name);
+    }
+    return handle;
+}
+
+int sim_mem_read(int handle, int addr) {
+    const SimMem &m = *mems[handle];
+    return (uint32_t)addr < m.words ? (int)m.data[addr] : 0;
+}
+
+void sim_mem_write(int handle, int addr, int data, int mask) {
+    SimMem &m = *mems[handle];
+    if ((uint32_t)addr >= m.words) return;
+    uint32_t bits = 0;
+    for (int lane = 0; lane < 4; lane++) {
+        if (mask & (1 << lane)) bits |= 0xFFu << (8 * lane);
+    }
+    bits &= width_mask(m.width);
+    m.data[addr] = (m.data[addr] & ~bits) | ((uint32_t)data & bits);
+}
+
+// Quartus MIF: "addr : value;" and "[first..last] : value;" in CONTENT
+static bool load_mif(SimMem &m, const std::string &path) {
+    FILE *f = std::fopen(path.c_str(), "r");
+    if (!f) {
+        std::fprintf(stderr, "warning: %s not found, %s starts zeroed\n", path.c_str(), m.name.c_str());
+        return false;
+    }
+    std::string text;
+    char buf[4096];
+    size_t n;
+    while ((n = std::fread(buf, 1, sizeof(buf), f)) > 0) text.append(buf, n);
+    std::fclose(f);
+
+    // Drop "--" comments
+    std::string clean;
+    for (size_t i = 0; i < text.size(); i++) {
+        if (text[i] == '-' && i + 1 < text.size() && text[i + 1] == '-') {
+            while (i < text.size() && text[i] != '\n') i++;
+        }
+        if (i < text.size()) clean += text[i];
+    }
+
+    int addr_radix = 16, data_radix = 16;
+    auto radix = [](const std::string &s) {
+        if (s.find("HEX") != std::string::npos) return 16;
+        if (s.find("BIN") != std::string::npos) return 2;
+        if (s.find("OCT") != std::string::npos) return 8;
+        return 10;
+    };
+
+    size_t content = clean.find("CONTENT");
+    std::string header = clean.substr(0, content);
+    size_t p;
+    if ((p = header.find("ADDRESS_RADIX")) != std::string::npos) addr_radix = radix(header.substr(p + 13, 8));
+    if ((p = header.find("DATA_RADIX")) != std::string::npos) data_radix = radix(header.substr(p + 10, 8));
+    if (content == std::string::npos) return false;
+
+    size_t begin = clean.find("BEGIN", content);
+    size_t end = clean.rfind("END");
+    std::string body = clean.substr(begin + 5, end - begin - 5);
+
+    size_t pos = 0;
+    while ((p = body.find(';', pos)) != std::string::npos) {
+        std::string entry = body.substr(pos, p - pos);
+        pos = p + 1;
+        size_t colon = entry.find(':');
+        if (colon == std::string::npos) continue;
+        std::string where = entry.substr(0, colon);
+        uint32_t first, last;
+        size_t dots = where.find("..");
+        if (dots != std::string::npos) {
+            first = std::strtoul(where.substr(where.find('[') + 1).c_str(), nullptr, addr_radix);
+            last = std::strtoul(where.substr(dots + 2).c_str(), nullptr, addr_radix);
+        } else {
+            first = last = std::strtoul(where.c_str(), nullptr, addr_radix);
+        }
+
+        // One value fills a range; several values fill consecutive words
+        std::vector<uint32_t> values;
+        const char *s = entry.c_str() + colon + 1;
+        char *next;
+        for (;;) {
+            uint32_t v = std::strtoul(s, &next, data_radix);
+            if (next == s) break;
+            values.push_back(v & width_mask(m.width));
+            s = next;
+        }
+        if (values.empty()) continue;
+        if (values.size() == 1) {
+            for (uint32_t a = first; a <= last && a < m.words; a++) m.data[a] = values[0];
+        } else {
+            for (size_t i = 0; i < values.size() && first + i < m.words; i++) m.data[first + i] = values[i];
+        }
+    }
+    return true;
+}
+
+// ============================================
+// CPU address space on top of the memories
+// ============================================
+
+static SimMem *bram, *sdram, *psram;
+
+static void create_memories() {
+    bram = mems[mem_get("core/firmware.mif", BRAM_BYTES / 4, 32)].get();
+    sdram = mems[mem_get("sdram", SDRAM_BYTES / 2, 16)].get();
+    psram = mems[mem_get("psram", PSRAM_BYTES / 2, 16)].get();
+    for (uint32_t i = 0; i < bram->words; i++) bram->data[i] = INSN_NOP;
+}
+
+// sdram_model stores beats at {bank, row, column}; io_sdram derives
+// those from the linear beat address (map_bank/map_row)
+static uint32_t sdram_index(uint32_t beat) {
+    uint32_t col = beat & 0x3FF;
+    if (SDRAM_ADDR_MAP == 0) return beat;
+    uint32_t bank = (beat >> 10) & 3;
+    uint32_t row = beat >> 12;
+    if (SDRAM_ADDR_MAP == 2) {
+        for (uint32_t r = row; r; r >>= 2) bank ^= r & 3;
+    }
+    return bank << 23 | row << 10 | col;
+}
+
+// Location of a byte: memory word and bit offset
+//   SDRAM: the first 16-bit beat of a 32-bit word holds bits [31:16]
+//   PSRAM: psram_controller writes bits [15:0] to the even halfword
+static bool locate(uint32_t addr, uint32_t *&word, int &shift) {
+    uint32_t lane = addr & 3;
+    if (addr - BRAM_BASE < BRAM_BYTES) {
+        word = &bram->data[(addr - BRAM_BASE) >> 2];
+        shift = 8 * lane;
+    } else if (addr - SDRAM_BASE < SDRAM_BYTES) {
+        uint32_t hw = ((addr - SDRAM_BASE) >> 2) * 2 + (lane < 2 ? 1 : 0);
+        word = &sdram->data[sdram_index(hw)];
+        shift = 8 * (lane & 1);
+    } else if (addr - PSRAM_BASE < PSRAM_BYTES) {
+        uint32_t hw = ((addr - PSRAM_BASE) >> 2) * 2 + (lane < 2 ? 0 : 1);
+        word = &psram->data[hw];
+        shift = 8 * (lane & 1);
+    } else {
+        return false;
+    }
+    return true;
+}
+
+static bool poke8(uint32_t addr, uint8_t value) {
+    uint32_t *word;
+    int shift;
+    if (!locate(addr, word, shift)) return false;
+    *word = (*word & ~(0xFFu << shift)) | ((uint32_t)value << shift);
+    return true;
+}
+
+static uint8_t peek8(uint32_t addr) {
+    uint32_t *word;
+    int shift;
+    return locate(addr, word, shift) ? (uint8_t)(*word >> shift) : 0;
+}
+
+static uint32_t peek32(uint32_t addr) {
+    return peek8(addr) | peek8(addr + 1) << 8 | peek8(addr + 2) << 16 | (uint32_t)peek8(addr + 3) << 24;
+}
+
+// ============================================
+// Firmware loading
+// ============================================
+
+static std::map<std::string, uint32_t> symbols;
+
+static bool read_file(const char *path, std::vector<uint8_t> &data) {
+    FILE *f = std::fopen(path, "rb");
+    if (!f) {
+        std::fprintf(stderr, "error: cannot open %s\n", path);
+        return false;
+    }
+    std::fseek(f, 0, SEEK_END);
+    data.resize(std::ftell(f));
+    std::fseek(f, 0, SEEK_SET);
+    bool ok = std::fread(data.data(), 1, data.size(), f) == data.size();
+    std::fclose(f);
+    return ok;
+}
+
+static bool load_binary(const char *path, uint32_t base) {
+    std::vector<uint8_t> data;
+    if (!read_file(path, data)) return false;
+    for (size_t i = 0; i < data.size(); i++) {
+        if (!poke8(base + i, data[i])) {
+            std::fprintf(stderr, "error: %s does not fit at 0x%08x\n", path, base);
+            return false;
+        }
+    }
+    return true;
+}
+
+// PT_LOAD segments go to their load address, so BRAM, SDRAM and PSRAM
+// contents match firmware.mif plus the data slot image
+static bool load_elf(const char *path) {
+    std::vector<uint8_t> data;
+    if (!read_file(path, data)) return false;
+    const Elf32_Ehdr *eh = (const Elf32_Ehdr *)data.data();
+    if (data.size() < sizeof(*eh) || std::memcmp(eh->e_ident, ELFMAG, SELFMAG) ||
+        eh->e_ident[EI_CLASS] != ELFCLASS32 || eh->e_machine != EM_RISCV) {
+        std::fprintf(stderr, "error: %s is not a 32-bit RISC-V ELF\n", path);
+        return false;
+    }
+
+    for (int i = 0; i < eh->e_phnum; i++) {
+        const Elf32_Phdr *ph = (const Elf32_Phdr *)(data.data() + eh->e_phoff + i * eh->e_phentsize);
+        if (ph->p_type != PT_LOAD) continue;
+        for (uint32_t j = 0; j < ph->p_filesz; j++) {
+            if (!poke8(ph->p_paddr + j, data[ph->p_offset + j])) {
+                std::fprintf(stderr, "error: segment at 0x%08x is outside memory\n", ph->p_paddr);
+                return false;
+            }
+        }
+    }
+
+    const Elf32_Shdr *sh = (const Elf32_Shdr *)(data.data() + eh->e_shoff);
+    for (int i = 0; eh->e_shoff && i < eh->e_shnum; i++) {
+        if (sh[i].sh_type != SHT_SYMTAB) continue;
+        const Elf32_Sym *sym = (const Elf32_Sym *)(data.data() + sh[i].sh_offset);
+        const char *strtab = (const char *)data.data() + sh[sh[i].sh_link].sh_offset;
+        for (uint32_t j = 0; j < sh[i].sh_size / sizeof(Elf32_Sym); j++) {
+            if (sym[j].st_name) symbols[strtab + sym[j].st_name] = sym[j].st_value;
+        }
+    }
+    return true;
+}
+
+// pgo_dump.c leaves pgo_stream[0..pgo_stream_len) for "make pgo-profile"
+static bool save_pgo_stream(const char *path) {
+    if (!symbols.count("pgo_stream") || !symbols.count("pgo_stream_len")) {
+        std::fprintf(stderr, "error: PGO_STREAM set but the ELF has no pgo_stream\n");
+        return false;
+    }
+    uint32_t base = symbols["pgo_stream"];
+    uint32_t len = peek32(symbols["pgo_stream_len"]);
+    FILE *f = std::fopen(path, "wb");
+    if (!f) {
+        std::fprintf(stderr, "error: cannot write %s\n", path);
+        return false;
+    }
+    for (uint32_t i = 0; i < len; i++) std::fputc(peek8(base + i), f);
+    std::fclose(f);
+    std::printf("pgo stream: %u bytes -> %s\n", len, path);
+    return true;
+}
+
+// perf.c: {magic, count, {char name[12], uint32 cycles, uint32 sdram_beats,
+//                         uint32 ibus_wait_ram}[]}
+static const uint32_t PERF_MAGIC = 0x46524550;   // "PERF"
+static const uint32_t PERF_MAX = 8;
+
+static void print_perf_results() {
+    if (!symbols.count("perf_results")) return;
+    uint32_t base = symbols["perf_results"];
+    if (peek32(base) != PERF_MAGIC) {
+        std::fprintf(stderr, "warning: perf_results not filled in\n");
+        return;
+    }
+    uint32_t count = std::min(peek32(base + 4), PERF_MAX);
+    for (uint32_t i = 0; i < count; i++) {
+        uint32_t entry = base + 8 + i * 24;
+        std::string name;
+        for (uint32_t j = 0; j < 12 && peek8(entry + j); j++) name += (char)peek8(entry + j);
+        uint32_t cycles = peek32(entry + 12), beats = peek32(entry + 16);
+        uint32_t ibus_wait = peek32(entry + 20);
+        std::printf("perf: %s %u\n", name.c_str(), cycles);
+        // SDRAM bandwidth efficiency: data beats per controller cycle
+        if (cycles)
+            std::printf("perf-sdram: %s %u beats, %.1f%% of cycles\n", name.c_str(), beats,
+                        100.0 * beats / cycles);
+        std::printf("perf-ibus: %s %u cycles waiting on BRAM fetches\n", name.c_str(), ibus_wait);
+    }
+}
+
+static void print_terminal() {
+    int handle = mem_find("core/vram_init.mif");
+    if (handle < 0) return;
+    const SimMem *vram = mems[handle].get();
+    std::vector<std::string> rows;
+    for (int r = 0; r < TERM_ROWS; r++) {
+        std::string row;
+        for (int c = 0; c < TERM_COLS; c++) {
+            int i = r * TERM_COLS + c;
+            char ch = (char)(vram->data[i / 4] >> (8 * (i % 4)));
+            row += (ch >= 32 && ch < 127) ? ch : ' ';
+        }
+        row.erase(row.find_last_not_of(' ') + 1);
+        rows.push_back(row);
+    }
+    while (!rows.empty() && rows.back().empty()) rows.pop_back();
+    for (auto &row : rows) std::printf("| %s\n", row.c_str());
+}
+
+// ============================================
+// SDRAM request trace (sim_soc.v)
+// ============================================
+
+// dram_sched.cpp trace format: <cycle> <source> <R|W> <addr> <beats>
+static FILE *sdram_trace;
+static const uint64_t *trace_clock;
+
+void sim_sdram_request(int source, int write, int addr, int beats) {
+    static const char *names[] = {"cpu", "video"};
+    if (!sdram_trace) return;
+    std::fprintf(sdram_trace, "%llu %s %c 0x%07x %d\n", (unsigned long long)*trace_clock,
+                 names[source & 1], write ? 'W' : 'R', (uint32_t)addr, beats);
+}
+
+// ============================================
+// Video capture
+// ============================================
+
+static void png_chunk(FILE *f, const char *type, const uint8_t *data, uint32_t len) {
+    uint8_t be[4] = {(uint8_t)(len >> 24), (uint8_t)(len >> 16), (uint8_t)(len >> 8), (uint8_t)len};
+    std::fwrite(be, 1, 4, f);
+    std::fwrite(type, 1, 4, f);
+    if (len) std::fwrite(data, 1, len, f);
+    uLong crc = crc32(0, (const Bytef *)type, 4);
+    if (len) crc = crc32(crc, data, len);
+    uint8_t crc_be[4] = {(uint8_t)(crc >> 24), (uint8_t)(crc >> 16), (uint8_t)(crc >> 8), (uint8_t)crc};
+    std::fwrite(crc_be, 1, 4, f);
+}
+
+// 8-bit RGB, no filtering
+static bool write_png(const std::string &path, const uint8_t *rgb, int w, int h) {
+    std::vector<uint8_t> raw;
+    raw.reserve((size_t)h * (w * 3 + 1));
+    for (int y = 0; y < h; y++) {
+        raw.push_back(0);
+        raw.insert(raw.end(), rgb + (size_t)y * w * 3, rgb + (size_t)(y + 1) * w * 3);
+    }
+    uLongf zlen = compressBound(raw.size());
+    std::vector<uint8_t> z(zlen);
+    if (compress2(z.data(), &zlen, raw.data(), raw.size(), 6) != Z_OK) return false;
+
+    FILE *f = std::fopen(path.c_str(), "wb");
+    if (!f) return false;
+    static const uint8_t sig[8] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+    std::fwrite(sig, 1, 8, f);
+    uint8_t ihdr[13] = {(uint8_t)(w >> 24), (uint8_t)(w >> 16), (uint8_t)(w >> 8), (uint8_t)w,
+                        (uint8_t)(h >> 24), (uint8_t)(h >> 16), (uint8_t)(h >> 8), (uint8_t)h,
+                        8, 2, 0, 0, 0};
+    png_chunk(f, "IHDR", ihdr, sizeof(ihdr));
+    png_chunk(f, "IDAT", z.data(), zlen);
+    png_chunk(f, "IEND", nullptr, 0);
+    return std::fclose(f) == 0;
+}
+
+// Rebuilds frames from the pixel stream as the scaler sees it: vs starts a
+// frame, de marks active pixels, and a falling de ends a line
+struct FrameCapture {
+    std::string dir;
+    int every = 1;
+    std::vector<uint8_t> frame, prev;
+    int x = 0, y = 0;
+    bool prev_de = false;
+    uint64_t frames = 0;        // complete frames seen
+    uint64_t changed = 0;       // ... that differ from the one before
+    uint64_t saved = 0;
+    bool error = false;
+
+    FrameCapture() : frame(VIDEO_W * VIDEO_H * 3, 0) {}
+
+    void end_frame() {
+        frames++;
+        if (frame != prev) changed++;
+        prev = frame;
+        if (dir.empty() || (frames - 1) % every) return;
+        char name[32];
+        std::snprintf(name, sizeof(name), "/frame_%04llu.png", (unsigned long long)saved);
+        if (!write_png(dir + name, frame.data(), VIDEO_W, VIDEO_H)) {
+            std::fprintf(stderr, "error: cannot write %s%s\n", dir.c_str(), name);
+            error = true;
+        }
+        saved++;
+    }
+
+    // Called after each clk_video rising edge
+    void pixel(bool de, bool vs, uint32_t rgb) {
+        if (vs) {
+            if (x || y) end_frame();
+            x = y = 0;
+        }
+        if (de) {
+            if (x < VIDEO_W && y < VIDEO_H) {
+                uint8_t *p = &frame[(y * VIDEO_W + x) * 3];
+                p[0] = rgb >> 16;
+                p[1] = rgb >> 8;
+                p[2] = rgb;
+            }
+            x++;
+        } else if (prev_de) {
+            x = 0;
+            y++;
+        }
+        prev_de = de;
+    }
+};
+
+// ============================================
+// Simulation
+// ============================================
+
+struct Soc {
+    std::unique_ptr<VerilatedContext> ctx;
+    std::unique_ptr<Vsim_soc> top;
+    uint64_t time_ps = 0;
+    uint64_t next_sys = SYS_HALF_PS, next_video = VIDEO_HALF_PS;
+    uint64_t cycles = 0;        // clk_sys rising edges
+    FrameCapture *capture = nullptr;
+
+    Soc() : ctx(new VerilatedContext), top(new Vsim_soc(ctx.get())) {
+        top->clk_sys = 0;
+        top->clk_video = 0;
+        top->reset_n = 0;
+        top->eval();
+    }
+
+    // Advance to the next clk_sys rising edge
+    void cycle() {
+        for (;;) {
+            bool sys_rise = false, video_rise = false;
+            time_ps = std::min(next_sys, next_video);
+            if (next_sys == time_ps) {
+                top->clk_sys = !top->clk_sys;
+                sys_rise = top->clk_sys;
+                next_sys += SYS_HALF_PS;
+            }
+            if (next_video == time_ps) {
+                top->clk_video = !top->clk_video;
+                video_rise = top->clk_video;
+                next_video += VIDEO_HALF_PS;
+            }
+            ctx->time(time_ps);
+            top->eval();
+            if (video_rise && capture) capture->pixel(top->vid_de, top->vid_vs, top->vid_rgb);
+            if (sys_rise) break;
+        }
+        cycles++;
+    }
+};
+
+static void usage() {
+    std::fprintf(stderr,
+                 "usage: Vsim_soc [--sdram FILE] [--until SYMBOL] [--max-cycles N]\n"
+                 "                [--capture DIR] [--every N] [--frames N] [--sdram-trace FILE] [-q] "
+                 "firmware.elf|firmware.bin\n");
+}
+
+int main(int argc, char **argv) {
+    const char *image = nullptr;
+    const char *sdram_image = nullptr;
+    const char *until = nullptr;
+    uint64_t max_cycles = 1000000000ull;
+    bool quiet = false;
+    FrameCapture capture;
+    uint64_t max_frames = 0;
+    const char *trace_path = nullptr;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--sdram" && i + 1 < argc) {
+            sdram_image = argv[++i];
+        } else if (arg == "--until" && i + 1 < argc) {
+            until = argv[++i];
+        } else if (arg == "--max-cycles" && i + 1 < argc) {
+            max_cycles = std::strtoull(argv[++i], nullptr, 0);
+        } else if (arg == "--capture" && i + 1 < argc) {
+            capture.dir = argv[++i];
+        } else if (arg == "--every" && i + 1 < argc) {
+            capture.every = std::max(1, std::atoi(argv[++i]));
+        } else if (arg == "--frames" && i + 1 < argc) {
+            max_frames = std::strtoull(argv[++i], nullptr, 0);
+        } else if (arg == "--sdram-trace" && i + 1 < argc) {
+            trace_path = argv[++i];
+        } else if (arg == "-q") {
+            quiet = true;
+        } else if (arg[0] != '-' && !image) {
+            image = argv[i];
+        } else {
+            usage();
+            return 2;
+        }
+    }
+    if (!image) {
+        usage();
+        return 2;
+    }
+
+    create_memories();
+    std::string path = image;
+    bool elf = path.size() > 4 && path.compare(path.size() - 4, 4, ".elf") == 0;
+    if (elf ? !load_elf(image) : !load_binary(image, BRAM_BASE)) return 2;
+    if (sdram_image && !load_binary(sdram_image, SDRAM_IMAGE)) return 2;
+
+    uint32_t until_pc = 0;
+    if (until) {
+        if (!symbols.count(until)) {
+            std::fprintf(stderr, "error: symbol %s not found\n", until);
+            return 2;
+        }
+        until_pc = symbols[until];
+    }
+
+    Soc soc;
+    soc.capture = &capture;
+    if (trace_path) {
+        sdram_trace = std::fopen(trace_path, "w");
+        if (!sdram_trace) {
+            std::fprintf(stderr, "error: cannot write %s\n", trace_path);
+            return 2;
+        }
+        std::fprintf(sdram_trace, "# Vsim_soc %s\n", image);
+        trace_clock = &soc.cycles;
+    }
+    while (soc.cycles < RESET_CYCLES) soc.cycle();
+    soc.top->reset_n = 1;
+
+    uint64_t start = soc.cycles;
+    uint64_t instructions = 0;
+    bool stopped = false;
+    while (soc.cycles - start < max_cycles) {
+        soc.cycle();
+        if (max_frames && capture.saved >= max_frames) {
+            std::printf("captured %llu frames\n", (unsigned long long)capture.saved);
+            stopped = true;
+            break;
+        }
+        if (!soc.top->retire_valid) continue;
+        instructions++;
+        if (soc.top->retire_insn == INSN_HALT) {
+            std::printf("halted at 0x%08x\n", soc.top->retire_pc);
+            stopped = true;
+            break;
+        }
+        if (until && soc.top->retire_pc == until_pc) {
+            std::printf("reached %s\n", until);
+            stopped = true;
+            break;
+        }
+    }
+
+    if (!quiet) print_terminal();
+    soc.top->final();   // sdram_checker summary
+    if (sdram_trace) std::fclose(sdram_trace);
+    if (!stopped) {
+        std::fprintf(stderr, "error: no halt after %llu cycles\n", (unsigned long long)max_cycles);
+        return 1;
+    }
+
+    std::printf("instructions: %llu\n", (unsigned long long)instructions);
+    std::printf("cycles: %llu\n", (unsigned long long)(soc.cycles - start));
+    print_perf_results();
+    if (capture.frames) {
+        // Changed frames per simulated second of CPU time since reset
+        double seconds = (soc.cycles - start) * 2 * SYS_HALF_PS * 1e-12;
+        std::printf("frames: %llu (%llu changed, %.1f fps)\n", (unsigned long long)capture.frames,
+                    (unsigned long long)capture.changed, capture.changed / seconds);
+    }
+    if (capture.error) return 1;
+    if (soc.top->sdram_violations) {
+        std::fprintf(stderr, "error: %u SDRAM protocol/timing violations\n", soc.top->sdram_violations);
+        return 1;
+    }
+
+    const char *pgo = std::getenv("PGO_STREAM");
+    if (pgo && !save_pgo_stream(pgo)) return 1;
+    return 0;
+}
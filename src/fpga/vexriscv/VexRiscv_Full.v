@@ -1,6 +1,8 @@
 // Generator : SpinalHDL v1.3.5    git head : f0505d24810c8661a24530409359554b7cfa271a
 // Date      : 09/06/2019, 12:34:34
 // Component : VexRiscv
+// Hand-patched: instret/instreth user CSRs, mhpmcounter3-6 with
+// mhpmevent3-6 selecting a bit of the hpmEvents input (see cpu_system.v)
 
 
 `define EnvCtrlEnum_defaultEncoding_type [1:0]
@@ -1061,6 +1063,7 @@ module VexRiscv (
       input   dBusWishbone_ERR,
       output [1:0] dBusWishbone_BTE,
       output [2:0] dBusWishbone_CTI,
+      input  [31:0] hpmEvents,
       input   clk,
       input   reset);
   wire  _zz_221_;
@@ -1999,6 +2002,14 @@ module VexRiscv (
   reg [31:0] CsrPlugin_mtval;
   reg [63:0] CsrPlugin_mcycle = 64'b0000000000000000000000000000000000000000000000000000000000000000;
   reg [63:0] CsrPlugin_minstret = 64'b0000000000000000000000000000000000000000000000000000000000000000;
+  reg [63:0] CsrPlugin_mhpmcounter3 = 64'b0000000000000000000000000000000000000000000000000000000000000000;
+  reg [63:0] CsrPlugin_mhpmcounter4 = 64'b0000000000000000000000000000000000000000000000000000000000000000;
+  reg [63:0] CsrPlugin_mhpmcounter5 = 64'b0000000000000000000000000000000000000000000000000000000000000000;
+  reg [63:0] CsrPlugin_mhpmcounter6 = 64'b0000000000000000000000000000000000000000000000000000000000000000;
+  reg [4:0] CsrPlugin_mhpmevent3;
+  reg [4:0] CsrPlugin_mhpmevent4;
+  reg [4:0] CsrPlugin_mhpmevent5;
+  reg [4:0] CsrPlugin_mhpmevent6;
   wire  _zz_198_;
   wire  _zz_199_;
   wire  _zz_200_;
@@ -5078,6 +5089,92 @@ module VexRiscv (
       12'b001101000010 : begin
         execute_CsrPlugin_illegalAccess = 1'b0;
       end
+      12'b110000000010 : begin
+        if(execute_CSR_READ_OPCODE)begin
+          execute_CsrPlugin_illegalAccess = 1'b0;
+        end
+      end
+      12'b110010000010 : begin
+        if(execute_CSR_READ_OPCODE)begin
+          execute_CsrPlugin_illegalAccess = 1'b0;
+        end
+      end
+      12'b101100000011 : begin
+        execute_CsrPlugin_illegalAccess = 1'b0;
+      end
+      12'b101110000011 : begin
+        execute_CsrPlugin_illegalAccess = 1'b0;
+      end
+      12'b110000000011 : begin
+        if(execute_CSR_READ_OPCODE)begin
+          execute_CsrPlugin_illegalAccess = 1'b0;
+        end
+      end
+      12'b110010000011 : begin
+        if(execute_CSR_READ_OPCODE)begin
+          execute_CsrPlugin_illegalAccess = 1'b0;
+        end
+      end
+      12'b001100100011 : begin
+        execute_CsrPlugin_illegalAccess = 1'b0;
+      end
+      12'b101100000100 : begin
+        execute_CsrPlugin_illegalAccess = 1'b0;
+      end
+      12'b101110000100 : begin
+        execute_CsrPlugin_illegalAccess = 1'b0;
+      end
+      12'b110000000100 : begin
+        if(execute_CSR_READ_OPCODE)begin
+          execute_CsrPlugin_illegalAccess = 1'b0;
+        end
+      end
+      12'b110010000100 : begin
+        if(execute_CSR_READ_OPCODE)begin
+          execute_CsrPlugin_illegalAccess = 1'b0;
+        end
+      end
+      12'b001100100100 : begin
+        execute_CsrPlugin_illegalAccess = 1'b0;
+      end
+      12'b101100000101 : begin
+        execute_CsrPlugin_illegalAccess = 1'b0;
+      end
+      12'b101110000101 : begin
+        execute_CsrPlugin_illegalAccess = 1'b0;
+      end
+      12'b110000000101 : begin
+        if(execute_CSR_READ_OPCODE)begin
+          execute_CsrPlugin_illegalAccess = 1'b0;
+        end
+      end
+      12'b110010000101 : begin
+        if(execute_CSR_READ_OPCODE)begin
+          execute_CsrPlugin_illegalAccess = 1'b0;
+        end
+      end
+      12'b001100100101 : begin
+        execute_CsrPlugin_illegalAccess = 1'b0;
+      end
+      12'b101100000110 : begin
+        execute_CsrPlugin_illegalAccess = 1'b0;
+      end
+      12'b101110000110 : begin
+        execute_CsrPlugin_illegalAccess = 1'b0;
+      end
+      12'b110000000110 : begin
+        if(execute_CSR_READ_OPCODE)begin
+          execute_CsrPlugin_illegalAccess = 1'b0;
+        end
+      end
+      12'b110010000110 : begin
+        if(execute_CSR_READ_OPCODE)begin
+          execute_CsrPlugin_illegalAccess = 1'b0;
+        end
+      end
+      12'b001100100110 : begin
+        execute_CsrPlugin_illegalAccess = 1'b0;
+      end
       default : begin
       end
     endcase
@@ -5204,6 +5301,72 @@ module VexRiscv (
         execute_CsrPlugin_readData[31 : 31] = CsrPlugin_mcause_interrupt;
         execute_CsrPlugin_readData[3 : 0] = CsrPlugin_mcause_exceptionCode;
       end
+      12'b110000000010 : begin
+        execute_CsrPlugin_readData[31 : 0] = CsrPlugin_minstret[31 : 0];
+      end
+      12'b110010000010 : begin
+        execute_CsrPlugin_readData[31 : 0] = CsrPlugin_minstret[63 : 32];
+      end
+      12'b101100000011 : begin
+        execute_CsrPlugin_readData[31 : 0] = CsrPlugin_mhpmcounter3[31 : 0];
+      end
+      12'b101110000011 : begin
+        execute_CsrPlugin_readData[31 : 0] = CsrPlugin_mhpmcounter3[63 : 32];
+      end
+      12'b110000000011 : begin
+        execute_CsrPlugin_readData[31 : 0] = CsrPlugin_mhpmcounter3[31 : 0];
+      end
+      12'b110010000011 : begin
+        execute_CsrPlugin_readData[31 : 0] = CsrPlugin_mhpmcounter3[63 : 32];
+      end
+      12'b001100100011 : begin
+        execute_CsrPlugin_readData[4 : 0] = CsrPlugin_mhpmevent3;
+      end
+      12'b101100000100 : begin
+        execute_CsrPlugin_readData[31 : 0] = CsrPlugin_mhpmcounter4[31 : 0];
+      end
+      12'b101110000100 : begin
+        execute_CsrPlugin_readData[31 : 0] = CsrPlugin_mhpmcounter4[63 : 32];
+      end
+      12'b110000000100 : begin
+        execute_CsrPlugin_readData[31 : 0] = CsrPlugin_mhpmcounter4[31 : 0];
+      end
+      12'b110010000100 : begin
+        execute_CsrPlugin_readData[31 : 0] = CsrPlugin_mhpmcounter4[63 : 32];
+      end
+      12'b001100100100 : begin
+        execute_CsrPlugin_readData[4 : 0] = CsrPlugin_mhpmevent4;
+      end
+      12'b101100000101 : begin
+        execute_CsrPlugin_readData[31 : 0] = CsrPlugin_mhpmcounter5[31 : 0];
+      end
+      12'b101110000101 : begin
+        execute_CsrPlugin_readData[31 : 0] = CsrPlugin_mhpmcounter5[63 : 32];
+      end
+      12'b110000000101 : begin
+        execute_CsrPlugin_readData[31 : 0] = CsrPlugin_mhpmcounter5[31 : 0];
+      end
+      12'b110010000101 : begin
+        execute_CsrPlugin_readData[31 : 0] = CsrPlugin_mhpmcounter5[63 : 32];
+      end
+      12'b001100100101 : begin
+        execute_CsrPlugin_readData[4 : 0] = CsrPlugin_mhpmevent5;
+      end
+      12'b101100000110 : begin
+        execute_CsrPlugin_readData[31 : 0] = CsrPlugin_mhpmcounter6[31 : 0];
+      end
+      12'b101110000110 : begin
+        execute_CsrPlugin_readData[31 : 0] = CsrPlugin_mhpmcounter6[63 : 32];
+      end
+      12'b110000000110 : begin
+        execute_CsrPlugin_readData[31 : 0] = CsrPlugin_mhpmcounter6[31 : 0];
+      end
+      12'b110010000110 : begin
+        execute_CsrPlugin_readData[31 : 0] = CsrPlugin_mhpmcounter6[63 : 32];
+      end
+      12'b001100100110 : begin
+        execute_CsrPlugin_readData[4 : 0] = CsrPlugin_mhpmevent6;
+      end
       default : begin
       end
     endcase
@@ -5433,6 +5596,10 @@ module VexRiscv (
       execute_CsrPlugin_wfiWake <= 1'b0;
       memory_DivPlugin_div_counter_value <= (6'b000000);
       _zz_210_ <= (32'b00000000000000000000000000000000);
+      CsrPlugin_mhpmevent3 <= (5'b00000);
+      CsrPlugin_mhpmevent4 <= (5'b00000);
+      CsrPlugin_mhpmevent5 <= (5'b00000);
+      CsrPlugin_mhpmevent6 <= (5'b00000);
       execute_arbitration_isValid <= 1'b0;
       memory_arbitration_isValid <= 1'b0;
       writeBack_arbitration_isValid <= 1'b0;
@@ -5671,6 +5838,26 @@ module VexRiscv (
         end
         12'b001101000010 : begin
         end
+        12'b001100100011 : begin
+          if(execute_CsrPlugin_writeEnable)begin
+            CsrPlugin_mhpmevent3 <= execute_CsrPlugin_writeData[4 : 0];
+          end
+        end
+        12'b001100100100 : begin
+          if(execute_CsrPlugin_writeEnable)begin
+            CsrPlugin_mhpmevent4 <= execute_CsrPlugin_writeData[4 : 0];
+          end
+        end
+        12'b001100100101 : begin
+          if(execute_CsrPlugin_writeEnable)begin
+            CsrPlugin_mhpmevent5 <= execute_CsrPlugin_writeData[4 : 0];
+          end
+        end
+        12'b001100100110 : begin
+          if(execute_CsrPlugin_writeEnable)begin
+            CsrPlugin_mhpmevent6 <= execute_CsrPlugin_writeData[4 : 0];
+          end
+        end
         default : begin
         end
       endcase
@@ -5727,6 +5914,18 @@ module VexRiscv (
     if(writeBack_arbitration_isFiring)begin
       CsrPlugin_minstret <= (CsrPlugin_minstret + (64'b0000000000000000000000000000000000000000000000000000000000000001));
     end
+    if(hpmEvents[CsrPlugin_mhpmevent3])begin
+      CsrPlugin_mhpmcounter3 <= (CsrPlugin_mhpmcounter3 + (64'b0000000000000000000000000000000000000000000000000000000000000001));
+    end
+    if(hpmEvents[CsrPlugin_mhpmevent4])begin
+      CsrPlugin_mhpmcounter4 <= (CsrPlugin_mhpmcounter4 + (64'b0000000000000000000000000000000000000000000000000000000000000001));
+    end
+    if(hpmEvents[CsrPlugin_mhpmevent5])begin
+      CsrPlugin_mhpmcounter5 <= (CsrPlugin_mhpmcounter5 + (64'b0000000000000000000000000000000000000000000000000000000000000001));
+    end
+    if(hpmEvents[CsrPlugin_mhpmevent6])begin
+      CsrPlugin_mhpmcounter6 <= (CsrPlugin_mhpmcounter6 + (64'b0000000000000000000000000000000000000000000000000000000000000001));
+    end
     if(_zz_254_)begin
       CsrPlugin_exceptionPortCtrl_exceptionContext_code <= (_zz_202_ ? IBusCachedPlugin_decodeExceptionPort_payload_code : decodeExceptionPort_payload_code);
       CsrPlugin_exceptionPortCtrl_exceptionContext_badAddr <= (_zz_202_ ? IBusCachedPlugin_decodeExceptionPort_payload_badAddr : decodeExceptionPort_payload_badAddr);
@@ -6047,6 +6246,46 @@ module VexRiscv (
           CsrPlugin_mcause_exceptionCode <= execute_CsrPlugin_writeData[3 : 0];
         end
       end
+      12'b101100000011 : begin
+        if(execute_CsrPlugin_writeEnable)begin
+          CsrPlugin_mhpmcounter3[31 : 0] <= execute_CsrPlugin_writeData[31 : 0];
+        end
+      end
+      12'b101110000011 : begin
+        if(execute_CsrPlugin_writeEnable)begin
+          CsrPlugin_mhpmcounter3[63 : 32] <= execute_CsrPlugin_writeData[31 : 0];
+        end
+      end
+      12'b101100000100 : begin
+        if(execute_CsrPlugin_writeEnable)begin
+          CsrPlugin_mhpmcounter4[31 : 0] <= execute_CsrPlugin_writeData[31 : 0];
+        end
+      end
+      12'b101110000100 : begin
+        if(execute_CsrPlugin_writeEnable)begin
+          CsrPlugin_mhpmcounter4[63 : 32] <= execute_CsrPlugin_writeData[31 : 0];
+        end
+      end
+      12'b101100000101 : begin
+        if(execute_CsrPlugin_writeEnable)begin
+          CsrPlugin_mhpmcounter5[31 : 0] <= execute_CsrPlugin_writeData[31 : 0];
+        end
+      end
+      12'b101110000101 : begin
+        if(execute_CsrPlugin_writeEnable)begin
+          CsrPlugin_mhpmcounter5[63 : 32] <= execute_CsrPlugin_writeData[31 : 0];
+        end
+      end
+      12'b101100000110 : begin
+        if(execute_CsrPlugin_writeEnable)begin
+          CsrPlugin_mhpmcounter6[31 : 0] <= execute_CsrPlugin_writeData[31 : 0];
+        end
+      end
+      12'b101110000110 : begin
+        if(execute_CsrPlugin_writeEnable)begin
+          CsrPlugin_mhpmcounter6[63 : 32] <= execute_CsrPlugin_writeData[31 : 0];
+        end
+      end
       default : begin
       end
     endcase
@@ -0,0 +1,25 @@
+#!/bin/sh
+#
+# Re-apply the local changes to a regenerated VexRiscv netlist
+#
+# VexRiscv_Full.v is SpinalHDL output with hand edits on top; the edits
+# live in the *.patch files next to it. After regenerating the netlist,
+# run this to apply them again (patches already applied are skipped):
+#
+#   src/fpga/vexriscv/apply_patches.sh [VexRiscv_Full.v]
+#
+
+set -e
+
+dir=$(cd "$(dirname "$0")" && pwd)
+target=${1:-$dir/VexRiscv_Full.v}
+
+for p in "$dir"/*.patch; do
+    name=$(basename "$p")
+    if patch --dry-run -R -s -f "$target" < "$p" > /dev/null 2>&1; then
+        echo "$name: already applied"
+    else
+        patch -s "$target" < "$p"
+        echo "$name: applied"
+    fi
+done
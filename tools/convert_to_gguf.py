@@ -16,67 +16,9 @@ https://github.com/ggerganov/ggml/blob/master/docs/gguf.md
 import struct
 import sys
 import os
-from pathlib import Path
+import numpy as np
 
-# GGUF constants
-GGUF_MAGIC = 0x46554747  # "GGUF" in little-endian
-GGUF_VERSION = 3
-
-# GGUF value types
-GGUF_TYPE_UINT32 = 4
-GGUF_TYPE_INT32 = 5
-GGUF_TYPE_FLOAT32 = 6
-GGUF_TYPE_STRING = 8
-GGUF_TYPE_ARRAY = 9
-
-# GGML tensor types
-GGML_TYPE_F32 = 0
-GGML_TYPE_F16 = 1
-
-
-def write_gguf_string(f, s):
-    """Write a GGUF string (length + bytes, NOT null-terminated)."""
-    encoded = s.encode('utf-8')
-    f.write(struct.pack('<Q', len(encoded)))
-    f.write(encoded)
-
-
-def write_gguf_kv_string(f, key, value):
-    """Write a string key-value pair."""
-    write_gguf_string(f, key)
-    f.write(struct.pack('<I', GGUF_TYPE_STRING))
-    write_gguf_string(f, value)
-
-
-def write_gguf_kv_uint32(f, key, value):
-    """Write a uint32 key-value pair."""
-    write_gguf_string(f, key)
-    f.write(struct.pack('<I', GGUF_TYPE_UINT32))
-    f.write(struct.pack('<I', value))
-
-
-def write_gguf_kv_int32(f, key, value):
-    """Write an int32 key-value pair."""
-    write_gguf_string(f, key)
-    f.write(struct.pack('<I', GGUF_TYPE_INT32))
-    f.write(struct.pack('<i', value))
-
-
-def write_gguf_kv_float32(f, key, value):
-    """Write a float32 key-value pair."""
-    write_gguf_string(f, key)
-    f.write(struct.pack('<I', GGUF_TYPE_FLOAT32))
-    f.write(struct.pack('<f', value))
-
-
-def write_gguf_kv_string_array(f, key, values):
-    """Write a string array key-value pair."""
-    write_gguf_string(f, key)
-    f.write(struct.pack('<I', GGUF_TYPE_ARRAY))
-    f.write(struct.pack('<I', GGUF_TYPE_STRING))
-    f.write(struct.pack('<Q', len(values)))
-    for v in values:
-        write_gguf_string(f, v)
+import gguf
 
 
 def read_llama2c_config(model_data):
@@ -126,8 +68,7 @@ def convert_to_gguf(model_path, tokenizer_path, output_path, use_fp16=False):
     """Convert llama2.c format to GGUF."""
 
     print(f"Reading model from {model_path}...")
-    with open(model_path, 'rb') as f:
-        model_data = f.read()
+    model_data = np.memmap(model_path, dtype=np.uint8, mode='r')
 
     print(f"Reading tokenizer from {tokenizer_path}...")
     with open(tokenizer_path, 'rb') as f:
@@ -173,10 +114,9 @@ def convert_to_gguf(model_path, tokenizer_path, output_path, use_fp16=False):
     # =====================================================
 
     def read_weights(offset, count):
-        """Read count float32 values from model_data at offset."""
+        """View count float32 values of model_data at offset (no copy)."""
         end = offset + count * 4
-        data = model_data[offset:end]
-        return struct.unpack(f'<{count}f', data), end
+        return model_data[offset:end].view('<f4'), end
 
     offset = 28  # Skip config header
 
@@ -301,115 +241,39 @@ def convert_to_gguf(model_path, tokenizer_path, output_path, use_fp16=False):
         tensors.append(('output.weight', [vocab_size, dim]))
         tensor_data['output.weight'] = wcls
 
-    # Build metadata KV pairs
-    metadata = [
-        ('general.architecture', 'string', 'llama'),
-        ('general.name', 'string', 'llama2c-converted'),
-        ('llama.context_length', 'uint32', seq_len),
-        ('llama.embedding_length', 'uint32', dim),
-        ('llama.block_count', 'uint32', n_layers),
-        ('llama.feed_forward_length', 'uint32', hidden_dim),
-        ('llama.attention.head_count', 'uint32', n_heads),
-        ('llama.attention.head_count_kv', 'uint32', n_kv_heads),
-        ('llama.rope.dimension_count', 'uint32', head_size),
-        ('tokenizer.ggml.model', 'string', 'llama'),
-        ('tokenizer.ggml.tokens', 'string_array', tokens),
-        ('tokenizer.ggml.scores', 'float_array', scores),
-        ('tokenizer.ggml.bos_token_id', 'uint32', 1),
-        ('tokenizer.ggml.eos_token_id', 'uint32', 2),
-    ]
-
     print(f"Writing GGUF to {output_path}...")
 
-    with open(output_path, 'wb') as f:
-        # Write header
-        f.write(struct.pack('<I', GGUF_MAGIC))
-        f.write(struct.pack('<I', GGUF_VERSION))
-        f.write(struct.pack('<Q', len(tensors)))  # n_tensors
-        f.write(struct.pack('<Q', len(metadata)))  # n_kv
-
-        # Write metadata
-        for key, vtype, value in metadata:
-            if vtype == 'string':
-                write_gguf_kv_string(f, key, value)
-            elif vtype == 'uint32':
-                write_gguf_kv_uint32(f, key, value)
-            elif vtype == 'int32':
-                write_gguf_kv_int32(f, key, value)
-            elif vtype == 'float32':
-                write_gguf_kv_float32(f, key, value)
-            elif vtype == 'string_array':
-                write_gguf_kv_string_array(f, key, value)
-            elif vtype == 'float_array':
-                # Write float array
-                write_gguf_string(f, key)
-                f.write(struct.pack('<I', GGUF_TYPE_ARRAY))
-                f.write(struct.pack('<I', GGUF_TYPE_FLOAT32))
-                f.write(struct.pack('<Q', len(value)))
-                for v in value:
-                    f.write(struct.pack('<f', v))
-
-        # Calculate offset for tensor data (aligned to 32 bytes)
-        tensor_info_start = f.tell()
-
-        # First pass: calculate tensor info size
-        tensor_type = GGML_TYPE_F16 if use_fp16 else GGML_TYPE_F32
-        bytes_per_element = 2 if use_fp16 else 4
-
-        # Calculate tensor info section size
-        tensor_info_size = 0
-        for name, shape in tensors:
-            tensor_info_size += 8 + len(name.encode('utf-8'))  # name string
-            tensor_info_size += 4  # n_dims
-            tensor_info_size += 8 * len(shape)  # dims
-            tensor_info_size += 4  # type
-            tensor_info_size += 8  # offset
-
-        # Data section starts after tensor infos, aligned to 32 bytes
-        data_start_offset = tensor_info_start + tensor_info_size
-        data_start_offset = (data_start_offset + 31) & ~31
-
-        # Write tensor infos
-        current_offset = 0
-        for name, shape in tensors:
-            write_gguf_string(f, name)
-            f.write(struct.pack('<I', len(shape)))  # n_dims
-            for dim_size in shape:
-                f.write(struct.pack('<Q', dim_size))
-            f.write(struct.pack('<I', tensor_type))
-            f.write(struct.pack('<Q', current_offset))
-
-            # Calculate size and advance offset
-            n_elements = 1
-            for d in shape:
-                n_elements *= d
-            current_offset += n_elements * bytes_per_element
-
-        # Pad to alignment
-        current_pos = f.tell()
-        padding_needed = data_start_offset - current_pos
-        if padding_needed > 0:
-            f.write(b'\x00' * padding_needed)
-
-        # Write tensor data
-        print("Writing tensor data...")
-        for name, shape in tensors:
-            weights = tensor_data[name]
-            n_elements = 1
-            for d in shape:
-                n_elements *= d
-
-            if use_fp16:
-                # Convert to FP16
-                import numpy as np
-                weights_np = np.array(weights, dtype=np.float32)
-                weights_fp16 = weights_np.astype(np.float16)
-                f.write(weights_fp16.tobytes())
-            else:
-                # Write as F32
-                f.write(struct.pack(f'<{n_elements}f', *weights))
-
-            print(f"  {name}: {shape} ({n_elements} elements)")
+    writer = gguf.GGUFWriter(output_path)
+
+    # Metadata
+    writer.add_string('general.architecture', 'llama')
+    writer.add_string('general.name', 'llama2c-converted')
+    writer.add_uint32('llama.context_length', seq_len)
+    writer.add_uint32('llama.embedding_length', dim)
+    writer.add_uint32('llama.block_count', n_layers)
+    writer.add_uint32('llama.feed_forward_length', hidden_dim)
+    writer.add_uint32('llama.attention.head_count', n_heads)
+    writer.add_uint32('llama.attention.head_count_kv', n_kv_heads)
+    writer.add_uint32('llama.rope.dimension_count', head_size)
+    writer.add_string('tokenizer.ggml.model', 'llama')
+    writer.add_array('tokenizer.ggml.tokens', gguf.GGUF_TYPE_STRING, tokens)
+    writer.add_array('tokenizer.ggml.scores', gguf.GGUF_TYPE_FLOAT32, scores)
+    writer.add_uint32('tokenizer.ggml.bos_token_id', 1)
+    writer.add_uint32('tokenizer.ggml.eos_token_id', 2)
+
+    # Tensor infos, then tensor data written in place
+    tensor_type = gguf.GGML_TYPE_F16 if use_fp16 else gguf.GGML_TYPE_F32
+    for name, shape in tensors:
+        writer.add_tensor(name, shape, tensor_type)
+    writer.write_header()
+
+    print("Writing tensor data...")
+    for (name, shape), tensor in zip(tensors, writer.tensors):
+        dst = writer.tensor_data(tensor)
+        dst[:] = gguf.quantize(tensor_type, tensor_data[name])
+        dst.flush()
+        del dst
+        print(f"  {name}: {shape} ({tensor.n_elements} elements)")
 
     output_size = os.path.getsize(output_path)
     print(f"Done! Output: {output_path} ({output_size / 1024 / 1024:.2f} MB)")
@@ -420,7 +284,7 @@ def main():
         print("Usage: python convert_to_gguf.py model.bin tokenizer.bin output.gguf [--fp16]")
         print()
         print("Options:")
-        print("  --fp16    Convert weights to FP16 (requires numpy)")
+        print("  --fp16    Convert weights to FP16")
         sys.exit(1)
 
     model_path = sys.argv[1]
@@ -0,0 +1,85 @@
+#!/usr/bin/env python3
+"""
+Convert a GGUF model to Q4_Q16 weights for the DMA dot product accelerator.
+
+Q4_Q16 format: 20 bytes per 32 elements (Q16.16 scale + 32 4-bit values)
+Q16.16 format: 4 bytes per element (32-bit signed fixed-point)
+
+Weight matrices whose rows are a whole number of 32-element blocks are
+quantized to Q4_Q16, which dma_dot_product unpacks in hardware (CTRL
+q4_mode). Everything else (norm vectors, odd-sized matrices) becomes
+Q16.16, since the CPU reads those directly.
+
+For a 14MB Q8 model (~13M elements):
+  - Q8: 14MB
+  - Q4_Q16: 8MB (6.4x less weight traffic than Q16.16)
+
+Check the accuracy cost with tools/eval_perplexity.py.
+
+Usage:
+    python tools/convert_to_q4.py [-j JOBS] [--keep GLOB] input.gguf output.gguf
+"""
+
+import argparse
+import fnmatch
+from pathlib import Path
+
+import gguf
+
+# Source types that can be requantized; anything else is copied unchanged
+CONVERT_TYPES = (gguf.GGML_TYPE_Q8_0, gguf.GGML_TYPE_F16, gguf.GGML_TYPE_F32, gguf.GGML_TYPE_I32)
+
+
+def target_type(t, keep_patterns):
+    """Q4 for block-aligned matrices, Q16.16 for the rest."""
+    if t.dtype not in CONVERT_TYPES:
+        return t.dtype
+    if len(t.dims) >= 2 and t.dims[-1] % 32 == 0 and \
+            not any(fnmatch.fnmatchcase(t.name, p) for p in keep_patterns):
+        return gguf.GGML_TYPE_Q4_Q16
+    return gguf.GGML_TYPE_I32
+
+
+def convert_to_q4(input_path, output_path, keep_patterns=(), jobs=None):
+    """Convert a GGUF model to Q4_Q16 weights."""
+    print(f"Converting {input_path} -> {output_path}")
+
+    reader = gguf.GGUFReader(input_path)
+    print(f"GGUF v{reader.version}: {len(reader.tensors)} tensors, {len(reader.keys)} metadata entries")
+
+    writer = gguf.GGUFWriter(output_path, reader.version, reader.alignment)
+    writer.add_metadata_bytes(reader.metadata_bytes(), len(reader.keys))
+
+    q4_count = 0
+    q4_elements = 0
+    for t in reader.tensors:
+        dtype = target_type(t, keep_patterns)
+        if dtype != t.dtype:
+            print(f"  Converting {t.name}: {t.type_name} -> {gguf.GGML_TYPE_NAMES[dtype]} "
+                  f"({t.n_elements:,} elements)")
+        writer.add_tensor(t.name, t.dims, dtype)
+        if dtype == gguf.GGML_TYPE_Q4_Q16:
+            q4_count += 1
+            q4_elements += t.n_elements
+
+    writer.write_header()
+    gguf.stream_tensors(reader, writer, jobs)
+
+    print(f"Quantized {q4_count} tensors to Q4_Q16 ({q4_elements:,} elements total)")
+
+    in_size = Path(input_path).stat().st_size
+    out_size = Path(output_path).stat().st_size
+    print(f"Done! {in_size/1024/1024:.1f}MB -> {out_size/1024/1024:.1f}MB")
+
+
+if __name__ == '__main__':
+    parser = argparse.ArgumentParser(description='Convert GGUF weights to Q4_Q16 for the DMA accelerator')
+    parser.add_argument('input', help='Input GGUF file (Q8_0, F16, F32 or Q16.16)')
+    parser.add_argument('output', help='Output Q4_Q16 GGUF file')
+    parser.add_argument('--keep', action='append', default=[], metavar='GLOB',
+                        help='Keep matching tensors at Q16.16 (repeatable)')
+    parser.add_argument('-j', '--jobs', type=int, default=None,
+                        help='Worker processes (default: number of CPUs)')
+    args = parser.parse_args()
+
+    convert_to_q4(args.input, args.output, args.keep, args.jobs)
@@ -0,0 +1,174 @@
+#!/usr/bin/env python3
+"""
+Accuracy and throughput of one model across on-device number formats.
+
+Starts from a single GGUF (F32 or Q8_0, as convert_to_gguf.py writes),
+derives each weight format from it in memory and runs the llama_ref
+forward pass with the arithmetic the Pocket uses:
+
+  - weight matrices reach the accelerator as Q16.16: directly (q16),
+    through the Q4 mode dequantizer (q4), or converted by the CPU
+    (fp16, q8_0; the accelerator has no float or int8 input)
+  - activations are truncated to Q16.16 before every matrix-vector
+    product, which follows src/fpga/sim/accel_ref.c: full 64-bit
+    products summed modulo 2^64, then the arithmetic >> 16
+  - norm weights are Q16.16; norms, RoPE, softmax and SwiGLU stay in
+    float32 (their firmware cost is compute, not accuracy)
+
+LENGTH above 511 is split across several accelerator runs by the
+firmware; the 64-bit sums of the pieces add up to the same result, so
+each row is one dot product here.
+
+Reports perplexity, its change versus float, mean KL divergence and
+top-1 agreement with float, plus SDRAM bytes moved per token and the
+tokens/s they allow at a given SDRAM bandwidth. The estimate is a
+bandwidth bound: it ignores compute, so it is optimistic for fp16 and
+q8_0, whose conversion runs on the CPU.
+
+Usage:
+    python tools/eval_formats.py model.gguf --text sample.txt --bandwidth 106
+"""
+
+import argparse
+import sys
+import numpy as np
+from pathlib import Path
+
+import gguf
+import llama_ref
+from eval_perplexity import DEFAULT_TEXT, log_softmax
+
+# On-device weight matrix format; blocked formats fall back to Q16.16
+# for rows that are not whole blocks, as convert_to_q4.py does
+FORMATS = {
+    'q16': gguf.GGML_TYPE_I32,
+    'fp16': gguf.GGML_TYPE_F16,
+    'q8_0': gguf.GGML_TYPE_Q8_0,
+    'q4': gguf.GGML_TYPE_Q4_Q16,
+}
+
+# Burst read rate from docs/sdram-reference/05-timing-analysis.md
+DEFAULT_BANDWIDTH = 106.0  # MB/s
+
+
+def matrix_type(dims, dtype):
+    block_elements = gguf.GGML_TYPE_LAYOUT[dtype][0]
+    return dtype if dims[-1] % block_elements == 0 else gguf.GGML_TYPE_I32
+
+
+def q4_dequant(blocks, n_elements):
+    """accel_ref_q4_dequant(): (q - 8) * scale, truncated to 32 bits."""
+    shifts = np.arange(8, dtype=np.uint32) * 4
+    q = ((blocks['qs'][:, :, None] >> shifts) & 0xF).reshape(len(blocks), 32).astype(np.int64) - 8
+    return (q * blocks['d'][:, None]).astype(np.int32).reshape(-1)[:n_elements]
+
+
+def to_device_q16(dtype, data, n_elements):
+    """Q16.16 words the accelerator multiplies for a stored tensor."""
+    if dtype == gguf.GGML_TYPE_I32:
+        return np.asarray(data, dtype=np.int32)
+    elif dtype == gguf.GGML_TYPE_Q4_Q16:
+        return q4_dequant(data, n_elements)
+    return gguf.float_to_q16_16(gguf.dequantize(dtype, data, n_elements))
+
+
+class AccelModel(llama_ref.Model):
+    """llama_ref.Model with weights in a device format and accelerator matmuls."""
+
+    def __init__(self, path, dtype, seq_len=None):
+        self.dtype = dtype
+        super().__init__(path, seq_len)
+
+    def weight(self, name):
+        t = self.reader.tensor(name)
+        w = self.reader.tensor_float(t)
+        if len(t.dims) == 1:
+            return gguf.dequantize(gguf.GGML_TYPE_I32, gguf.float_to_q16_16(w), len(w))
+        dtype = matrix_type(t.dims, self.dtype)
+        return to_device_q16(dtype, gguf.quantize(dtype, w), len(w)).reshape(t.dims)
+
+    def matmul(self, w, x):
+        acc = w.astype(np.int64) @ gguf.float_to_q16_16(x).astype(np.int64)
+        return (acc >> 16).astype(np.int32).astype(np.float32) / 65536.0
+
+    def embed(self, token):
+        return self.token_embd[token].astype(np.float32) / 65536.0
+
+
+def bytes_per_token(reader, dtype, model, n_tokens):
+    """Mean SDRAM bytes read and written per token over n_tokens positions."""
+    weights = 0
+    for t in reader.tensors:
+        n = int(np.prod(t.dims))
+        if len(t.dims) == 1:
+            weights += 4 * n
+        elif t.name == 'token_embd.weight' and model.output is not model.token_embd:
+            weights += gguf.tensor_size(matrix_type(t.dims, dtype), t.dims[-1])  # One row
+        else:
+            weights += gguf.tensor_size(matrix_type(t.dims, dtype), n)
+
+    # Input vector of each matrix (read once with cached B)
+    layer = model.layers[0]
+    vectors = sum(layer[name].shape[1] for name in (
+        'attn_q', 'attn_k', 'attn_v', 'attn_output', 'ffn_gate', 'ffn_up', 'ffn_down'))
+    vectors = 4 * (model.n_layers * vectors + model.output.shape[1])
+
+    # Q16.16 KV cache: one K and V row written per layer, all earlier ones read
+    mean_rows = (n_tokens + 1) / 2.0
+    kv = 4 * 2 * model.n_layers * model.kv_dim * (1 + mean_rows)
+    return weights, weights + vectors + kv
+
+
+def eval_formats(path, formats, text, max_tokens, bandwidth):
+    reference = llama_ref.Model(path)
+    tokens = llama_ref.Tokenizer(reference.reader).encode(text)[:max_tokens]
+    if len(tokens) < 2:
+        raise ValueError("Need at least 2 tokens of text")
+    targets = np.array(tokens[1:])
+    print(f"Evaluating {len(targets)} tokens, SDRAM bandwidth {bandwidth:.1f} MB/s")
+
+    def run(model):
+        model.reset()
+        return np.stack([log_softmax(model.forward(tok, pos)) for pos, tok in enumerate(tokens[:-1])])
+
+    print(f"  {'format':<8} {'weights':>9} {'MB/tok':>8} {'tok/s':>7} "
+          f"{'ppl':>10} {'vs float':>9} {'KL':>10} {'top-1':>7}")
+    ref_logp = run(reference)
+    ref_ppl = float(np.exp(-ref_logp[np.arange(len(targets)), targets].mean()))
+    print(f"  {'float':<8} {'':>9} {'':>8} {'':>7} {ref_ppl:>10.4f}")
+
+    for name in formats:
+        model = AccelModel(path, FORMATS[name])
+        logp = run(model)
+        ppl = float(np.exp(-logp[np.arange(len(targets)), targets].mean()))
+        kl = float((np.exp(ref_logp) * (ref_logp - logp)).sum(axis=1).mean())
+        top1 = float((logp.argmax(axis=1) == ref_logp.argmax(axis=1)).mean())
+        weights, moved = bytes_per_token(reference.reader, FORMATS[name], model, len(targets))
+        print(f"  {name:<8} {weights / 1e6:>7.2f}MB {moved / 1e6:>8.3f} {bandwidth * 1e6 / moved:>7.2f} "
+              f"{ppl:>10.4f} {100.0 * (ppl / ref_ppl - 1):>+8.2f}% {kl:>10.6f} {100.0 * top1:>6.1f}%")
+
+
+if __name__ == '__main__':
+    parser = argparse.ArgumentParser(description='Compare on-device number formats for accuracy and throughput')
+    parser.add_argument('model', help='Reference GGUF (F32 or Q8_0)')
+    parser.add_argument('--formats', default=','.join(FORMATS),
+                        help=f'Comma-separated formats (default: {",".join(FORMATS)})')
+    parser.add_argument('--text', help='Text file to evaluate (default: a short built-in story)')
+    parser.add_argument('-n', '--max-tokens', type=int, default=256,
+                        help='Evaluate at most this many tokens (default: 256)')
+    parser.add_argument('--bandwidth', type=float, default=DEFAULT_BANDWIDTH,
+                        help=f'Measured SDRAM bandwidth in MB/s (default: {DEFAULT_BANDWIDTH:g})')
+    args = parser.parse_args()
+
+    formats = [f.strip() for f in args.formats.split(',') if f.strip()]
+    unknown = [f for f in formats if f not in FORMATS]
+    if unknown:
+        print(f"Error: unknown format(s) {', '.join(unknown)}; choose from {', '.join(FORMATS)}")
+        sys.exit(1)
+
+    text = Path(args.text).read_text() if args.text else DEFAULT_TEXT
+    try:
+        eval_formats(args.model, formats, text, args.max_tokens, args.bandwidth)
+    except (ValueError, KeyError) as e:
+        print(f"Error: {e}")
+        sys.exit(1)
@@ -0,0 +1,78 @@
+#!/usr/bin/env python3
+"""
+Compare perplexity of the same model in different weight formats.
+
+Runs the llama_ref forward pass of every GGUF over one token sequence and
+reports perplexity, plus agreement with the first (reference) model:
+mean KL divergence of the next-token distributions and how often the
+top-1 token matches. Use it to decide whether a format (e.g. Q4_Q16 from
+convert_to_q4.py) is good enough before running it on the Pocket.
+
+The text is tokenized with the reference model's tokenizer.
+
+Usage:
+    python tools/eval_perplexity.py --text sample.txt \\
+        model_q8.gguf model_q16.gguf model_q4.gguf
+"""
+
+import argparse
+import sys
+import numpy as np
+from pathlib import Path
+
+import llama_ref
+
+DEFAULT_TEXT = (
+    "Once upon a time, there was a little girl named Lily. She loved to play "
+    "outside in the park with her friends. One day, she saw a big red ball "
+    "under a tree. She ran to get it, but a small dog got there first."
+)
+
+
+def log_softmax(logits):
+    z = logits - logits.max()
+    return z - np.log(np.exp(z).sum())
+
+
+def evaluate(path, tokens):
+    """Per-position log-probabilities over the vocabulary."""
+    model = llama_ref.Model(path, seq_len=len(tokens))
+    return np.stack([log_softmax(model.forward(tok, pos)) for pos, tok in enumerate(tokens[:-1])])
+
+
+def eval_perplexity(paths, text, max_tokens):
+    reference = llama_ref.Model(paths[0], seq_len=1)
+    tokens = llama_ref.Tokenizer(reference.reader).encode(text)[:max_tokens]
+    if len(tokens) < 2:
+        raise ValueError("Need at least 2 tokens of text")
+    targets = np.array(tokens[1:])
+    print(f"Evaluating {len(targets)} tokens")
+
+    print(f"  {'model':<32} {'ppl':>10} {'vs ref':>8} {'KL':>10} {'top-1':>7}")
+    ref_logp = None
+    ref_ppl = None
+    for path in paths:
+        logp = evaluate(path, tokens)
+        ppl = float(np.exp(-logp[np.arange(len(targets)), targets].mean()))
+        if ref_logp is None:
+            ref_logp, ref_ppl = logp, ppl
+        kl = float((np.exp(ref_logp) * (ref_logp - logp)).sum(axis=1).mean())
+        top1 = float((logp.argmax(axis=1) == ref_logp.argmax(axis=1)).mean())
+        print(f"  {Path(path).name:<32} {ppl:>10.4f} {100.0 * (ppl / ref_ppl - 1):>+7.2f}% "
+              f"{kl:>10.6f} {100.0 * top1:>6.1f}%")
+
+
+if __name__ == '__main__':
+    parser = argparse.ArgumentParser(description='Compare perplexity across GGUF weight formats')
+    parser.add_argument('models', nargs='+', help='GGUF files; the first is the reference')
+    parser.add_argument('--text', help='Text file to evaluate (default: a short built-in story)')
+    parser.add_argument('-n', '--max-tokens', type=int, default=256,
+                        help='Evaluate at most this many tokens (default: 256)')
+    args = parser.parse_args()
+
+    text = Path(args.text).read_text() if args.text else DEFAULT_TEXT
+    try:
+        eval_perplexity(args.models, text, args.max_tokens)
+    except (ValueError, KeyError) as e:
+        print(f"Error: {e}")
+        sys.exit(1)
@@ -0,0 +1,245 @@
+#!/usr/bin/env python3
+"""
+Export a GGUF model as an accelerator-ready SDRAM image.
+
+dma_dot_product fetches each weight row with one burst, and io_sdram pays
+ACT/PRECHARGE whenever a burst crosses a 2KB SDRAM row (1024 x 16-bit
+columns). This pass lays every tensor out so row fetches stay inside a
+page:
+
+  - all weights are converted to Q16.16 (the DMA's native format),
+    except Q4_Q16 matrices (convert_to_q4.py), which stay packed for the
+    DMA's q4_mode
+  - every tensor starts on a page
+  - rows of up to a page get a power-of-two stride (--row-align pow2,
+    default) or a full page each (--row-align page); longer rows are
+    padded to a whole number of pages
+  - with --tile, matching Q16.16 matrices are pre-tiled into blocks of whole
+    rows of at most 4096 elements (one BRAM weight cache load), each
+    block starting on a page
+
+The image starts with the layout table described in
+src/firmware/weight_layout.h, so firmware can find a tensor and compute
+row addresses without parsing GGUF. --header also writes a C header with
+table indices and sizes for compile-time use.
+
+The image is written in place into a pre-sized file, a bounded number of
+rows at a time.
+
+Usage:
+    python tools/export_layout.py model_q16.gguf model_layout.bin
+    python tools/export_layout.py --tile '*attn_output*' --header model_layout.h \\
+        model_q16.gguf model_layout.bin
+"""
+
+import argparse
+import fnmatch
+import re
+import struct
+import sys
+import numpy as np
+from pathlib import Path
+
+import gguf
+
+# Must match src/firmware/weight_layout.h
+WL_MAGIC = 0x59414C57  # "WLAY"
+WL_VERSION = 1
+WL_PAGE_BYTES = 2048
+WL_CACHE_ELEMENTS = 4096
+WL_NAME_LEN = 40
+WL_FLAG_TILED = 1 << 0
+WL_FLAG_Q4 = 1 << 1
+WL_HEADER = struct.Struct('<4I')
+WL_ENTRY = struct.Struct(f'<{WL_NAME_LEN}s4I2HI')
+
+# Entry offsets count bytes from the image start; strides and sizes count
+# 32-bit words (one Q16.16 element)
+ELEMENT_BYTES = 4
+PAGE_ELEMENTS = WL_PAGE_BYTES // ELEMENT_BYTES
+Q4_BLOCK_WORDS = gguf.Q4_Q16_BLOCK.itemsize // ELEMENT_BYTES
+
+# SDRAM space left for model data above the firmware region (0x00800000)
+SDRAM_MODEL_BYTES = 56 * 1024 * 1024
+
+
+def next_pow2(n):
+    return 1 << (n - 1).bit_length()
+
+
+def plan_tensor(t, row_align, tile):
+    """Work out rows, strides and padded size of one tensor (in 32-bit words;
+    plan_layout() then assigns its offset in bytes).
+
+    Tensors follow convert_to_gguf's [rows, cols] dimension order.
+    """
+    cols = t.dims[-1]
+    rows = t.n_elements // cols
+    q4 = t.dtype == gguf.GGML_TYPE_Q4_Q16
+    entry = {
+        'name': t.name,
+        'rows': rows,
+        'cols': cols,
+        'words': cols // 32 * Q4_BLOCK_WORDS if q4 else cols,
+        'flags': WL_FLAG_Q4 if q4 else 0,
+        'tile_rows': 0,
+        'tile_stride': 0,
+    }
+    words = entry['words']
+
+    # The weight cache holds Q16.16 only, so Q4 matrices are never tiled
+    if tile and not q4 and rows > 1 and cols <= WL_CACHE_ELEMENTS:
+        tile_rows = min(rows, WL_CACHE_ELEMENTS // cols, 0xFFFF)
+        n_tiles = (rows + tile_rows - 1) // tile_rows
+        entry['flags'] = WL_FLAG_TILED
+        entry['row_stride'] = cols
+        entry['tile_rows'] = tile_rows
+        entry['tile_stride'] = gguf.align(tile_rows * cols, PAGE_ELEMENTS)
+        entry['size'] = n_tiles * entry['tile_stride']
+        return entry
+
+    if rows == 1:
+        stride = words
+    elif words > PAGE_ELEMENTS or row_align == 'page':
+        stride = gguf.align(words, PAGE_ELEMENTS)
+    else:
+        stride = next_pow2(words)
+    entry['row_stride'] = stride
+    entry['size'] = gguf.align(rows * stride, PAGE_ELEMENTS)
+    return entry
+
+
+def tensor_q16(reader, t, start, count):
+    """Elements of a tensor as Q16.16, copying I32 tensors unchanged."""
+    if t.dtype == gguf.GGML_TYPE_I32:
+        return np.asarray(reader.tensor_data(t)[start:start + count])
+    return gguf.quantize(gguf.GGML_TYPE_I32, reader.tensor_float(t, start, count))
+
+
+def tensor_rows(reader, t, entry, r0, n):
+    """n rows as 32-bit words: packed Q4 blocks or Q16.16 elements."""
+    if entry['flags'] & WL_FLAG_Q4:
+        blocks_per_row = entry['cols'] // 32
+        blocks = reader.tensor_data(t)[r0 * blocks_per_row:(r0 + n) * blocks_per_row]
+        return np.ascontiguousarray(blocks).view('<i4').reshape(n, entry['words'])
+    cols = entry['cols']
+    return tensor_q16(reader, t, r0 * cols, n * cols).reshape(n, cols)
+
+
+def write_tensor(reader, t, entry, out_path, offset):
+    """Scatter a tensor's rows into its padded slot, a bounded chunk at a time."""
+    rows, words = entry['rows'], entry['words']
+    tiled = entry['flags'] & WL_FLAG_TILED
+    if tiled:
+        # One block per step, rows packed back to back inside it
+        step = entry['tile_rows']
+    else:
+        step = max(1, gguf.CHUNK_ELEMENTS // entry['row_stride'])
+
+    for i, r0 in enumerate(range(0, rows, step)):
+        n = min(step, rows - r0)
+        values = tensor_rows(reader, t, entry, r0, n)
+        if tiled:
+            base, stride = i * entry['tile_stride'], words
+        else:
+            base, stride = r0 * entry['row_stride'], entry['row_stride']
+        dst = np.memmap(out_path, dtype='<i4', mode='r+',
+                        offset=offset + base * ELEMENT_BYTES, shape=(n * stride,))
+        dst.reshape(n, stride)[:, :words] = values
+        dst.flush()
+        del dst
+
+
+def c_identifier(name):
+    return 'WL_' + re.sub(r'[^A-Za-z0-9]', '_', name).upper()
+
+
+def write_c_header(path, source, entries, image_bytes):
+    lines = [
+        f"/* Generated by tools/export_layout.py from {Path(source).name} - do not edit */",
+        "",
+        "#ifndef MODEL_LAYOUT_H",
+        "#define MODEL_LAYOUT_H",
+        "",
+        f"#define WL_IMAGE_BYTES   0x{image_bytes:08X}",
+        f"#define WL_N_ENTRIES     {len(entries)}",
+        "",
+        "/* Layout table indices (see weight_layout.h) */",
+    ]
+    width = max(len(c_identifier(e['name'])) for e in entries) + 1
+    for i, e in enumerate(entries):
+        lines.append(f"#define {c_identifier(e['name']):<{width}} {i}")
+    lines += ["", "#endif /* MODEL_LAYOUT_H */", ""]
+    Path(path).write_text('\n'.join(lines))
+
+
+def plan_layout(reader, row_align='pow2', tile_patterns=()):
+    """Plan the image: table first, then each tensor on a page boundary.
+
+    Returns (entries, image_bytes); entry offsets are image-relative bytes.
+    """
+    entries = []
+    for t in reader.tensors:
+        if len(t.name.encode('utf-8')) >= WL_NAME_LEN:
+            raise ValueError(f"Tensor name too long for layout table: {t.name}")
+        tile = any(fnmatch.fnmatchcase(t.name, p) for p in tile_patterns)
+        entries.append(plan_tensor(t, row_align, tile))
+
+    table_bytes = WL_HEADER.size + WL_ENTRY.size * len(entries)
+    offset = gguf.align(table_bytes, WL_PAGE_BYTES)
+    for e in entries:
+        e['offset'] = offset
+        offset += e['size'] * ELEMENT_BYTES
+    return entries, offset
+
+
+def export_layout(input_path, output_path, row_align='pow2', tile_patterns=(), header_path=None):
+    print(f"Exporting {input_path} -> {output_path}")
+    reader = gguf.GGUFReader(input_path)
+    entries, image_bytes = plan_layout(reader, row_align, tile_patterns)
+
+    with open(output_path, 'wb') as f:
+        f.write(WL_HEADER.pack(WL_MAGIC, WL_VERSION, len(entries), image_bytes))
+        for e in entries:
+            f.write(WL_ENTRY.pack(e['name'].encode('utf-8'), e['offset'], e['rows'], e['cols'],
+                                  e['row_stride'], e['tile_rows'], e['flags'], e['tile_stride']))
+        f.truncate(image_bytes)
+
+    # Fill in tensor data (padding stays zero)
+    data_bytes = 0
+    print(f"  {'name':<32} {'rows':>6} {'cols':>6} {'stride':>6} {'tile':>5} {'offset':>9} {'size':>10}")
+    for t, e in zip(reader.tensors, entries):
+        write_tensor(reader, t, e, output_path, e['offset'])
+        data_bytes += e['rows'] * e['words'] * ELEMENT_BYTES
+        tile = str(e['tile_rows']) if e['flags'] & WL_FLAG_TILED else \
+            'q4' if e['flags'] & WL_FLAG_Q4 else '-'
+        print(f"  {e['name']:<32} {e['rows']:>6} {e['cols']:>6} {e['row_stride']:>6} {tile:>5} "
+              f"{e['offset']:>9X} {e['size'] * ELEMENT_BYTES:>10,}")
+
+    overhead = image_bytes - data_bytes
+    print(f"Image: {image_bytes / 1024 / 1024:.2f}MB "
+          f"({overhead / 1024:.0f}KB table + padding, {100.0 * overhead / image_bytes:.1f}%)")
+    if image_bytes > SDRAM_MODEL_BYTES:
+        print(f"Warning: image exceeds the {SDRAM_MODEL_BYTES // 1024 // 1024}MB SDRAM model region")
+
+    if header_path:
+        write_c_header(header_path, input_path, entries, image_bytes)
+        print(f"Wrote {header_path}")
+
+
+if __name__ == '__main__':
+    parser = argparse.ArgumentParser(description='Export GGUF weights in accelerator SDRAM layout')
+    parser.add_argument('input', help='Input GGUF (any type gguf.py can dequantize)')
+    parser.add_argument('output', help='Output SDRAM image')
+    parser.add_argument('--row-align', choices=('pow2', 'page'), default='pow2',
+                        help='Stride for rows shorter than a page (default: pow2)')
+    parser.add_argument('--tile', action='append', default=[], metavar='GLOB',
+                        help='Pre-tile matching matrices into weight cache blocks (repeatable)')
+    parser.add_argument('--header', help='Also write a C header with table indices')
+    args = parser.parse_args()
+
+    try:
+        export_layout(args.input, args.output, args.row_align, args.tile, args.header)
+    except ValueError as e:
+        print(f"Error: {e}")
+        sys.exit(1)
@@ -0,0 +1,187 @@
+#!/usr/bin/env python3
+"""
+Export a GGUF model's tokenizer as a firmware-ready blob.
+
+The llama2.c tokenizer in GGUF (tokenizer.ggml.tokens/scores) is a plain
+string array; encoding against it on-device means linear string
+compares across the vocabulary for every merge. This precomputes the
+lookups src/firmware/tokenizer.c needs:
+
+  - a perfect hash (hash and displace) from token string to id, used for
+    the initial per-codepoint lookup
+  - a merge table: every (left, right) pair whose concatenation is a
+    token, sorted by pair for binary search, with the merged id and its
+    rank (dense rank of the score, 0 = merged first)
+  - a string pool (offsets + bytes) for decode
+
+Encoding then matches llama2.c's encode(): dummy space prefix, UTF-8
+codepoints with byte fallback (<0x00>..), then repeatedly merging the
+best-ranked adjacent pair, leftmost first on ties.
+
+Blob layout (little-endian, sections 4-byte aligned) is tok_header_t in
+src/firmware/tokenizer.h.
+
+Usage:
+    python tools/export_tokenizer.py model.gguf tokenizer.bin
+"""
+
+import argparse
+import struct
+import sys
+import numpy as np
+
+import gguf
+
+# Must match src/firmware/tokenizer.h
+TOK_MAGIC = 0x424B4F54  # "TOKB"
+TOK_VERSION = 1
+TOK_NONE = 0xFFFFFFFF
+TOK_HEADER = struct.Struct('<17I')
+TOK_MERGE = struct.Struct('<4I')  # left, right, id, rank
+
+MASK32 = 0xFFFFFFFF
+
+
+def tok_hash(data, seed):
+    """FNV-1a with a seeded basis and a murmur3 finaliser (tok_hash in tokenizer.c)."""
+    h = (0x811C9DC5 ^ seed) & MASK32
+    for b in data:
+        h = ((h ^ b) * 0x01000193) & MASK32
+    h ^= h >> 16
+    h = (h * 0x85EBCA6B) & MASK32
+    h ^= h >> 13
+    h = (h * 0xC2B2AE35) & MASK32
+    h ^= h >> 16
+    return h
+
+
+def next_pow2(n):
+    return 1 << max(0, (n - 1).bit_length())
+
+
+def build_hash(keys):
+    """Hash and displace: displacement per bucket so every key gets its own slot.
+
+    keys maps token bytes -> id. Returns (displacements, slots).
+    """
+    n_buckets = next_pow2(max(1, len(keys) // 4))
+    n_slots = next_pow2(len(keys))
+    buckets = [[] for _ in range(n_buckets)]
+    for key in keys:
+        buckets[tok_hash(key, 0) & (n_buckets - 1)].append(key)
+
+    displace = [0] * n_buckets
+    slots = [TOK_NONE] * n_slots
+    # Biggest buckets first, while the table is emptiest
+    for b in sorted(range(n_buckets), key=lambda b: -len(buckets[b])):
+        bucket = buckets[b]
+        if not bucket:
+            break
+        for d in range(1, 1 << 24):
+            placed = {tok_hash(k, d) & (n_slots - 1) for k in bucket}
+            if len(placed) == len(bucket) and all(slots[s] == TOK_NONE for s in placed):
+                break
+        else:
+            raise ValueError("Could not build perfect hash")
+        displace[b] = d
+        for k in bucket:
+            slots[tok_hash(k, d) & (n_slots - 1)] = keys[k]
+    return displace, slots
+
+
+def build_merges(tokens, scores, ids_by_string):
+    """All (left, right) -> merged pairs, with dense score ranks."""
+    unique_scores = sorted(set(float(s) for s in scores), reverse=True)
+    score_rank = {s: r for r, s in enumerate(unique_scores)}
+
+    merges = []
+    for merged, tok in enumerate(tokens):
+        for split in range(1, len(tok)):
+            lefts = ids_by_string.get(tok[:split])
+            rights = ids_by_string.get(tok[split:])
+            if not lefts or not rights:
+                continue
+            # llama2.c looks the concatenation up by string: first id wins
+            if ids_by_string[tok][0] != merged:
+                continue
+            for left in lefts:
+                for right in rights:
+                    merges.append((left, right, merged, score_rank[float(scores[merged])]))
+    merges.sort()
+    return merges
+
+
+def export_tokenizer(input_path, output_path):
+    reader = gguf.GGUFReader(input_path)
+    tokens = reader.get('tokenizer.ggml.tokens')
+    scores = reader.get('tokenizer.ggml.scores')
+    if tokens is None or scores is None:
+        raise ValueError("GGUF has no tokenizer.ggml.tokens/scores")
+    tokens = list(tokens)
+    scores = np.asarray(scores, dtype=np.float32)
+    vocab_size = len(tokens)
+    print(f"Vocabulary: {vocab_size} tokens")
+
+    ids_by_string = {}
+    for i, tok in enumerate(tokens):
+        ids_by_string.setdefault(tok, []).append(i)
+    keys = {tok: ids[0] for tok, ids in ids_by_string.items()}
+
+    displace, slots = build_hash(keys)
+    print(f"Perfect hash: {len(displace)} buckets, {len(slots)} slots")
+
+    merges = build_merges(tokens, scores, ids_by_string)
+    print(f"Merges: {len(merges)} pairs")
+
+    byte_base = ids_by_string.get(b'<0x00>', [TOK_NONE])[0]
+    space_id = ids_by_string.get(b' ', [TOK_NONE])[0]
+    bos = int(reader.get('tokenizer.ggml.bos_token_id', 1))
+    eos = int(reader.get('tokenizer.ggml.eos_token_id', 2))
+
+    # Sections in order, each 4-byte aligned
+    pool = b''.join(tokens)
+    offsets = np.zeros(vocab_size + 1, dtype='<u4')
+    offsets[1:] = np.cumsum([len(t) for t in tokens])
+
+    off = TOK_HEADER.size
+    off_displace = off
+    off += 4 * len(displace)
+    off_slots = off
+    off += 4 * len(slots)
+    off_merges = off
+    off += TOK_MERGE.size * len(merges)
+    off_offsets = off
+    off += 4 * (vocab_size + 1)
+    off_pool = off
+    blob_bytes = gguf.align(off + len(pool), 4)
+
+    header = TOK_HEADER.pack(
+        TOK_MAGIC, TOK_VERSION, blob_bytes, vocab_size,
+        max(len(t) for t in tokens), bos, eos, byte_base, space_id,
+        len(displace), len(slots), len(merges),
+        off_displace, off_slots, off_merges, off_offsets, off_pool)
+
+    with open(output_path, 'wb') as f:
+        f.write(header)
+        f.write(np.asarray(displace, dtype='<u4').tobytes())
+        f.write(np.asarray(slots, dtype='<u4').tobytes())
+        for m in merges:
+            f.write(TOK_MERGE.pack(*m))
+        f.write(offsets.tobytes())
+        f.write(pool)
+        f.write(b'\0' * (blob_bytes - off_pool - len(pool)))
+
+    print(f"Wrote {output_path}: {blob_bytes / 1024:.1f}KB")
+
+
+if __name__ == '__main__':
+    parser = argparse.ArgumentParser(description='Export a GGUF tokenizer as a firmware blob')
+    parser.add_argument('input', help='GGUF model with tokenizer.ggml.tokens/scores')
+    parser.add_argument('output', help='Output tokenizer blob')
+    args = parser.parse_args()
+
+    try:
+        export_tokenizer(args.input, args.output)
+    except ValueError as e:
+        print(f"Error: {e}")
+        sys.exit(1)
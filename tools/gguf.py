@@ -0,0 +1,510 @@
+#!/usr/bin/env python3
+"""
+Shared GGUF reader/writer for the model tools.
+
+GGUFReader mmaps a model file and parses only the header. Metadata values
+are decoded on first access and tensor data is exposed as zero-copy numpy
+views into the map, so opening a model costs the same regardless of size.
+
+GGUFWriter lays out a file from tensor descriptors, writes the header and
+pre-sizes the file so tensor data can be written in place through
+writable memmap views.
+
+stream_tensors() ties the two together: every tensor is split into chunks
+of at most CHUNK_ELEMENTS that worker processes convert between freshly
+mapped input and output ranges, keeping peak memory constant.
+
+GGUF format specification:
+https://github.com/ggerganov/ggml/blob/master/docs/gguf.md
+"""
+
+import os
+import struct
+import numpy as np
+from multiprocessing import Pool
+
+# GGUF constants
+GGUF_MAGIC = 0x46554747  # "GGUF" in little-endian
+GGUF_VERSION = 3
+GGUF_TENSOR_ALIGN = 32   # Tensor data offsets are padded to 32 bytes
+
+# GGUF value types
+GGUF_TYPE_UINT8 = 0
+GGUF_TYPE_INT8 = 1
+GGUF_TYPE_UINT16 = 2
+GGUF_TYPE_INT16 = 3
+GGUF_TYPE_UINT32 = 4
+GGUF_TYPE_INT32 = 5
+GGUF_TYPE_FLOAT32 = 6
+GGUF_TYPE_BOOL = 7
+GGUF_TYPE_STRING = 8
+GGUF_TYPE_ARRAY = 9
+GGUF_TYPE_UINT64 = 10
+GGUF_TYPE_INT64 = 11
+GGUF_TYPE_FLOAT64 = 12
+
+# Fixed-size value types: struct format
+GGUF_SCALAR_FORMATS = {
+    GGUF_TYPE_UINT8: '<B',
+    GGUF_TYPE_INT8: '<b',
+    GGUF_TYPE_UINT16: '<H',
+    GGUF_TYPE_INT16: '<h',
+    GGUF_TYPE_UINT32: '<I',
+    GGUF_TYPE_INT32: '<i',
+    GGUF_TYPE_FLOAT32: '<f',
+    GGUF_TYPE_BOOL: '<?',
+    GGUF_TYPE_UINT64: '<Q',
+    GGUF_TYPE_INT64: '<q',
+    GGUF_TYPE_FLOAT64: '<d',
+}
+
+# GGML tensor types
+GGML_TYPE_F32 = 0
+GGML_TYPE_F16 = 1
+GGML_TYPE_Q8_0 = 8
+GGML_TYPE_I32 = 18  # Q16.16 fixed-point for the DMA accelerator
+GGML_TYPE_Q4_Q16 = 1024  # Private: Q4 blocks with a Q16.16 scale (see below)
+
+GGML_TYPE_NAMES = {
+    GGML_TYPE_F32: 'F32',
+    GGML_TYPE_F16: 'F16',
+    GGML_TYPE_Q8_0: 'Q8_0',
+    GGML_TYPE_I32: 'Q16.16',
+    GGML_TYPE_Q4_Q16: 'Q4_Q16',
+}
+
+# Q8_0: 34 bytes per 32 elements (FP16 scale + 32 int8 values)
+Q8_0_BLOCK = np.dtype([('d', '<f2'), ('qs', 'i1', 32)])
+
+# Q4_Q16: 20 bytes per 32 elements, the dma_dot_product Q4 format.
+# Like Q4_0 (nibble q stored offset by 8, value = (q - 8) * d) but the
+# scale is a Q16.16 int32 so blocks stay 32-bit aligned for burst reads
+# and the hardware needs no FP16 decode. Element j of a block is nibble
+# j % 8 (bits 4k+3:4k) of word j / 8.
+Q4_Q16_BLOCK = np.dtype([('d', '<i4'), ('qs', '<u4', 4)])
+
+# Storage per type: (elements per block, numpy dtype of one block/element)
+GGML_TYPE_LAYOUT = {
+    GGML_TYPE_F32: (1, np.dtype('<f4')),
+    GGML_TYPE_F16: (1, np.dtype('<f2')),
+    GGML_TYPE_Q8_0: (32, Q8_0_BLOCK),
+    GGML_TYPE_I32: (1, np.dtype('<i4')),
+    GGML_TYPE_Q4_Q16: (32, Q4_Q16_BLOCK),
+}
+
+# Elements converted per chunk (multiple of every block size)
+CHUNK_ELEMENTS = 1 << 20
+
+
+def align(offset, alignment):
+    """Round offset up to a multiple of alignment."""
+    return (offset + alignment - 1) // alignment * alignment
+
+
+def tensor_size(dtype, n_elements):
+    """Size in bytes of n_elements of a tensor type (partial blocks round up)."""
+    if dtype not in GGML_TYPE_LAYOUT:
+        raise ValueError(f"Unknown tensor type: {dtype}")
+    block_elements, block_dtype = GGML_TYPE_LAYOUT[dtype]
+    return (n_elements + block_elements - 1) // block_elements * block_dtype.itemsize
+
+
+def view_tensor_data(buf, dtype, n_elements):
+    """View raw bytes as a tensor's numpy storage (elements or blocks)."""
+    block_elements, block_dtype = GGML_TYPE_LAYOUT[dtype]
+    n_items = (n_elements + block_elements - 1) // block_elements
+    return buf[:n_items * block_dtype.itemsize].view(block_dtype)
+
+
+def map_tensor_data(path, dtype, offset, n_elements, mode='r'):
+    """Map n_elements of tensor storage at a file offset.
+
+    Each call creates its own mapping; dropping the result unmaps it,
+    which is what keeps chunked conversion at constant RSS.
+    """
+    block_elements, block_dtype = GGML_TYPE_LAYOUT[dtype]
+    n_items = (n_elements + block_elements - 1) // block_elements
+    return np.memmap(path, dtype=block_dtype, mode=mode, offset=offset, shape=(n_items,))
+
+
+def dequantize(dtype, data, n_elements):
+    """Decode a tensor storage view to a float32 array."""
+    if dtype == GGML_TYPE_Q8_0:
+        scale = data['d'].astype(np.float32)
+        values = data['qs'].astype(np.float32)
+        return (scale[:, None] * values).reshape(-1)[:n_elements]
+    elif dtype == GGML_TYPE_F16:
+        return data.astype(np.float32)
+    elif dtype == GGML_TYPE_F32:
+        return np.asarray(data)
+    elif dtype == GGML_TYPE_I32:
+        return data.astype(np.float32) / 65536.0
+    elif dtype == GGML_TYPE_Q4_Q16:
+        shifts = np.arange(8, dtype=np.uint32) * 4
+        nibbles = (data['qs'][:, :, None] >> shifts) & 0xF
+        q = nibbles.reshape(len(data), 32).astype(np.int32) - 8
+        # Same integer product as the hardware, then to float
+        return ((q * data['d'][:, None]).astype(np.float32) / 65536.0).reshape(-1)[:n_elements]
+    raise ValueError(f"Cannot dequantize {GGML_TYPE_NAMES.get(dtype, dtype)}")
+
+
+def float_to_q16_16(float_array):
+    """Convert float32 array to Q16.16 fixed-point (int32) array."""
+    # Q16.16: multiply by 2^16 = 65536
+    # Clamp to int32 range to avoid overflow
+    scaled = float_array * 65536.0
+    scaled = np.clip(scaled, -2147483648, 2147483647)
+    return scaled.astype(np.int32)
+
+
+def quantize_q4_q16(float_array):
+    """Encode a float32 array as Q4_Q16 blocks (last block zero padded)."""
+    n_blocks = (len(float_array) + 31) // 32
+    x = np.zeros(n_blocks * 32, dtype=np.float32)
+    x[:len(float_array)] = float_array
+    x = x.reshape(n_blocks, 32)
+
+    # Q4_0 rule: the largest-magnitude value maps to -8
+    idx = np.abs(x).argmax(axis=1)
+    vmax = x[np.arange(n_blocks), idx]
+    d = np.round(vmax / -8.0 * 65536.0).astype(np.int64)
+    d = np.clip(d, -2147483648, 2147483647).astype(np.int32)
+
+    # Quantize against the rounded scale the hardware will use
+    scale = d.astype(np.float32) / 65536.0
+    inv = np.divide(1.0, scale, out=np.zeros_like(scale), where=scale != 0)
+    q = np.clip(np.round(x * inv[:, None]) + 8, 0, 15).astype(np.uint32)
+
+    blocks = np.zeros(n_blocks, dtype=Q4_Q16_BLOCK)
+    blocks['d'] = d
+    shifts = np.arange(8, dtype=np.uint32) * 4
+    blocks['qs'] = (q.reshape(n_blocks, 4, 8) << shifts).sum(axis=2, dtype=np.uint32)
+    return blocks
+
+
+def quantize_q8_0(float_array):
+    """Encode a float32 array as Q8_0 blocks (last block zero padded)."""
+    n_blocks = (len(float_array) + 31) // 32
+    x = np.zeros(n_blocks * 32, dtype=np.float32)
+    x[:len(float_array)] = float_array
+    x = x.reshape(n_blocks, 32)
+
+    # ggml rule: the largest magnitude maps to +-127
+    d = (np.abs(x).max(axis=1) / 127.0).astype(np.float16)
+    scale = d.astype(np.float32)
+    inv = np.divide(1.0, scale, out=np.zeros_like(scale), where=scale != 0)
+
+    blocks = np.zeros(n_blocks, dtype=Q8_0_BLOCK)
+    blocks['d'] = d
+    blocks['qs'] = np.clip(np.round(x * inv[:, None]), -127, 127).astype(np.int8)
+    return blocks
+
+
+def quantize(dtype, float_array):
+    """Encode a float32 array as tensor storage."""
+    if dtype == GGML_TYPE_Q4_Q16:
+        return quantize_q4_q16(float_array)
+    elif dtype == GGML_TYPE_Q8_0:
+        return quantize_q8_0(float_array)
+    elif dtype == GGML_TYPE_F16:
+        return float_array.astype(np.float16)
+    elif dtype == GGML_TYPE_F32:
+        return float_array.astype(np.float32)
+    elif dtype == GGML_TYPE_I32:
+        return float_to_q16_16(float_array)
+    raise ValueError(f"Cannot quantize to {GGML_TYPE_NAMES.get(dtype, dtype)}")
+
+
+class GGUFTensor:
+    """Tensor descriptor: name, shape, type and data offset."""
+
+    def __init__(self, name, dims, dtype, offset=0):
+        self.name = name
+        self.dims = list(dims)
+        self.dtype = dtype
+        self.offset = offset        # Relative to the data section
+        self.data_offset = None     # Absolute file offset, once known
+
+    @property
+    def n_elements(self):
+        n = 1
+        for d in self.dims:
+            n *= d
+        return n
+
+    @property
+    def nbytes(self):
+        return tensor_size(self.dtype, self.n_elements)
+
+    @property
+    def type_name(self):
+        return GGML_TYPE_NAMES.get(self.dtype, str(self.dtype))
+
+
+class GGUFReader:
+    """mmap-backed GGUF reader with lazy metadata and tensor views."""
+
+    def __init__(self, path):
+        self.path = path
+        self.data = np.memmap(path, dtype=np.uint8, mode='r')
+
+        magic, self.version, n_tensors, n_kv = struct.unpack_from('<IIQQ', self.data, 0)
+        if magic != GGUF_MAGIC:
+            raise ValueError(f"Invalid GGUF magic: 0x{magic:08X}")
+        pos = 24
+
+        # Metadata: remember where each value is, decode on demand
+        self.kv_start = pos
+        self._fields = {}
+        for _ in range(n_kv):
+            key, pos = self._read_string(pos)
+            vtype, = struct.unpack_from('<I', self.data, pos)
+            self._fields[key.decode('utf-8')] = (vtype, pos + 4)
+            pos = self._skip_value(pos + 4, vtype)
+        self.kv_end = pos
+
+        # Tensor infos
+        self.tensors = []
+        for _ in range(n_tensors):
+            name, pos = self._read_string(pos)
+            n_dims, = struct.unpack_from('<I', self.data, pos)
+            dims = struct.unpack_from(f'<{n_dims}Q', self.data, pos + 4)
+            pos += 4 + 8 * n_dims
+            dtype, offset = struct.unpack_from('<IQ', self.data, pos)
+            pos += 12
+            self.tensors.append(GGUFTensor(name.decode('utf-8'), dims, dtype, offset))
+
+        # Data section alignment
+        self.alignment = self.get('general.alignment', 32 if self.version >= 3 else 4)
+        self.data_start = align(pos, self.alignment)
+        for t in self.tensors:
+            t.data_offset = self.data_start + t.offset
+        self._by_name = {t.name: t for t in self.tensors}
+
+    def __enter__(self):
+        return self
+
+    def __exit__(self, *exc):
+        self.close()
+
+    def close(self):
+        """Drop the mapping (outstanding views keep it alive)."""
+        self.data = None
+
+    def _read_string(self, pos):
+        length, = struct.unpack_from('<Q', self.data, pos)
+        pos += 8
+        return self.data[pos:pos + length].tobytes(), pos + length
+
+    def _skip_value(self, pos, vtype):
+        if vtype in GGUF_SCALAR_FORMATS:
+            return pos + struct.calcsize(GGUF_SCALAR_FORMATS[vtype])
+        elif vtype == GGUF_TYPE_STRING:
+            length, = struct.unpack_from('<Q', self.data, pos)
+            return pos + 8 + length
+        elif vtype == GGUF_TYPE_ARRAY:
+            arr_type, count = struct.unpack_from('<IQ', self.data, pos)
+            pos += 12
+            if arr_type in GGUF_SCALAR_FORMATS:
+                return pos + count * struct.calcsize(GGUF_SCALAR_FORMATS[arr_type])
+            for _ in range(count):
+                pos = self._skip_value(pos, arr_type)
+            return pos
+        raise ValueError(f"Unknown GGUF value type: {vtype}")
+
+    def _read_value(self, pos, vtype):
+        if vtype in GGUF_SCALAR_FORMATS:
+            return struct.unpack_from(GGUF_SCALAR_FORMATS[vtype], self.data, pos)[0]
+        elif vtype == GGUF_TYPE_STRING:
+            return self._read_string(pos)[0]
+        elif vtype == GGUF_TYPE_ARRAY:
+            arr_type, count = struct.unpack_from('<IQ', self.data, pos)
+            pos += 12
+            if arr_type in GGUF_SCALAR_FORMATS:
+                # Numeric arrays are zero-copy views
+                item = np.dtype(GGUF_SCALAR_FORMATS[arr_type])
+                return self.data[pos:pos + count * item.itemsize].view(item)
+            items = []
+            for _ in range(count):
+                items.append(self._read_value(pos, arr_type))
+                pos = self._skip_value(pos, arr_type)
+            return items
+        raise ValueError(f"Unknown GGUF value type: {vtype}")
+
+    @property
+    def keys(self):
+        return list(self._fields)
+
+    def value_type(self, key):
+        """GGUF value type of a metadata key (item type for arrays)."""
+        vtype, pos = self._fields[key]
+        if vtype == GGUF_TYPE_ARRAY:
+            return vtype, struct.unpack_from('<I', self.data, pos)[0]
+        return vtype, None
+
+    def get(self, key, default=None):
+        """Decode a metadata value (strings are returned as bytes)."""
+        if key not in self._fields:
+            return default
+        vtype, pos = self._fields[key]
+        return self._read_value(pos, vtype)
+
+    def metadata_bytes(self):
+        """Raw metadata KV section, for copying through unchanged."""
+        return self.data[self.kv_start:self.kv_end].tobytes()
+
+    def tensor(self, name):
+        return self._by_name[name]
+
+    def tensor_data(self, tensor):
+        """Zero-copy view of a tensor's storage (elements or Q8_0 blocks)."""
+        if isinstance(tensor, str):
+            tensor = self._by_name[tensor]
+        start = tensor.data_offset
+        return view_tensor_data(self.data[start:start + tensor.nbytes], tensor.dtype, tensor.n_elements)
+
+    def tensor_float(self, tensor, start=0, count=None):
+        """Elements [start, start+count) dequantized to float32 (allocates)."""
+        if isinstance(tensor, str):
+            tensor = self._by_name[tensor]
+        if count is None:
+            count = tensor.n_elements - start
+        block_elements = GGML_TYPE_LAYOUT[tensor.dtype][0]
+        first = start // block_elements
+        last = (start + count + block_elements - 1) // block_elements
+        data = self.tensor_data(tensor)[first:last]
+        values = dequantize(tensor.dtype, data, (last - first) * block_elements)
+        skip = start - first * block_elements
+        return values[skip:skip + count]
+
+
+class GGUFWriter:
+    """Writes a GGUF header and pre-sizes the file for in-place tensor data."""
+
+    def __init__(self, path, version=GGUF_VERSION, alignment=32):
+        self.path = path
+        self.version = version
+        self.alignment = alignment
+        self.tensors = []
+        self._kv = []
+        self._n_kv = 0
+        self._data_size = 0
+        self.data_start = None
+
+    # Metadata
+
+    @staticmethod
+    def _string(s):
+        if isinstance(s, str):
+            s = s.encode('utf-8')
+        return struct.pack('<Q', len(s)) + s
+
+    def add_metadata_bytes(self, data, n_kv):
+        """Append raw KV entries (e.g. GGUFReader.metadata_bytes())."""
+        self._kv.append(data)
+        self._n_kv += n_kv
+
+    def add_value(self, key, vtype, value):
+        """Append a scalar or string KV entry."""
+        if vtype == GGUF_TYPE_STRING:
+            payload = self._string(value)
+        else:
+            payload = struct.pack(GGUF_SCALAR_FORMATS[vtype], value)
+        self.add_metadata_bytes(self._string(key) + struct.pack('<I', vtype) + payload, 1)
+
+    def add_string(self, key, value):
+        self.add_value(key, GGUF_TYPE_STRING, value)
+
+    def add_uint32(self, key, value):
+        self.add_value(key, GGUF_TYPE_UINT32, value)
+
+    def add_int32(self, key, value):
+        self.add_value(key, GGUF_TYPE_INT32, value)
+
+    def add_float32(self, key, value):
+        self.add_value(key, GGUF_TYPE_FLOAT32, value)
+
+    def add_array(self, key, arr_type, values):
+        """Append an array KV entry (numeric arrays are packed with numpy)."""
+        parts = [self._string(key), struct.pack('<IIQ', GGUF_TYPE_ARRAY, arr_type, len(values))]
+        if arr_type == GGUF_TYPE_STRING:
+            parts.extend(self._string(v) for v in values)
+        else:
+            parts.append(np.asarray(values, dtype=GGUF_SCALAR_FORMATS[arr_type]).tobytes())
+        self.add_metadata_bytes(b''.join(parts), 1)
+
+    # Tensors
+
+    def add_tensor(self, name, dims, dtype):
+        """Reserve space for a tensor; returns its descriptor."""
+        tensor = GGUFTensor(name, dims, dtype, self._data_size)
+        self.tensors.append(tensor)
+        self._data_size = align(self._data_size + tensor.nbytes, GGUF_TENSOR_ALIGN)
+        return tensor
+
+    def write_header(self):
+        """Write header, metadata and tensor infos, then size the file.
+
+        Tensor data (and padding) reads as zero until written.
+        """
+        with open(self.path, 'wb') as f:
+            f.write(struct.pack('<IIQQ', GGUF_MAGIC, self.version, len(self.tensors), self._n_kv))
+            for kv in self._kv:
+                f.write(kv)
+            for t in self.tensors:
+                f.write(self._string(t.name))
+                f.write(struct.pack('<I', len(t.dims)))
+                f.write(struct.pack(f'<{len(t.dims)}Q', *t.dims))
+                f.write(struct.pack('<IQ', t.dtype, t.offset))
+            self.data_start = align(f.tell(), self.alignment)
+            f.truncate(self.data_start + self._data_size)
+        for t in self.tensors:
+            t.data_offset = self.data_start + t.offset
+
+    def tensor_data(self, tensor):
+        """Writable view of a tensor's storage; flush() or drop it when done."""
+        return map_tensor_data(self.path, tensor.dtype, tensor.data_offset, tensor.n_elements, mode='r+')
+
+
+def _convert_chunk(job):
+    """Convert one chunk between freshly mapped input and output ranges.
+
+    job = (input_path, src_dtype, in_offset, output_path, dst_dtype, out_offset, count)
+    """
+    input_path, src_dtype, in_offset, output_path, dst_dtype, out_offset, count = job
+
+    src = map_tensor_data(input_path, src_dtype, in_offset, count)
+    dst = map_tensor_data(output_path, dst_dtype, out_offset, count, mode='r+')
+    if src_dtype == dst_dtype:
+        dst[:] = src
+    else:
+        dst[:] = quantize(dst_dtype, dequantize(src_dtype, src, count))
+    dst.flush()
+    del src, dst
+
+
+def stream_tensors(reader, writer, jobs=None):
+    """Fill every writer tensor from the reader tensor of the same name.
+
+    Tensors whose type changed are dequantized and re-encoded, the rest
+    are copied. writer.write_header() must have been called.
+    """
+    chunk_jobs = []
+    for out in writer.tensors:
+        src = reader.tensor(out.name)
+        block_elements = GGML_TYPE_LAYOUT[src.dtype][0]
+        step = CHUNK_ELEMENTS // block_elements * block_elements
+        for start in range(0, src.n_elements, step):
+            count = min(step, src.n_elements - start)
+            chunk_jobs.append((reader.path, src.dtype, src.data_offset + tensor_size(src.dtype, start),
+                               writer.path, out.dtype, out.data_offset + tensor_size(out.dtype, start),
+                               count))
+
+    jobs = jobs or os.cpu_count() or 1
+    if jobs > 1 and len(chunk_jobs) > 1:
+        with Pool(min(jobs, len(chunk_jobs))) as pool:
+            for _ in pool.imap_unordered(_convert_chunk, chunk_jobs):
+                pass
+    else:
+        for job in chunk_jobs:
+            _convert_chunk(job)
@@ -0,0 +1,190 @@
+#!/usr/bin/env python3
+"""
+Compare rendered frames against reference images.
+
+Checks the PNG frames written by the simulation harness
+(Vsim_soc --capture) against checked-in references, so rendering changes
+show up without a capture device or OCR. Either argument may be a single
+PNG or a directory; directories are compared file by file on matching
+names, and a reference with no captured counterpart is a failure.
+
+A pixel differs when any channel is off by more than --tolerance; an image
+fails when more than --max-pixels pixels differ. --diff-dir writes an image
+per failing frame with the differing pixels in red over a dimmed copy of
+the reference.
+
+Reads 8-bit greyscale/RGB/RGBA non-interlaced PNGs (what the harness and
+common tools write) with numpy and zlib only.
+
+Usage:
+    python tools/image_diff.py src/fpga/sim/frames tests/frames
+    python tools/image_diff.py --tolerance 8 --diff-dir /tmp/diff a.png b.png
+"""
+
+import argparse
+import struct
+import sys
+import zlib
+from pathlib import Path
+
+import numpy as np
+
+PNG_SIGNATURE = b'\x89PNG\r\n\x1a\n'
+PNG_CHANNELS = {0: 1, 2: 3, 6: 4}   # colour type -> channels
+
+
+def _paeth(a, b, c):
+    p = a + b - c
+    pa, pb, pc = abs(p - a), abs(p - b), abs(p - c)
+    if pa <= pb and pa <= pc:
+        return a
+    return b if pb <= pc else c
+
+
+def read_png(path):
+    """Decode a PNG to an (h, w, 3) uint8 array"""
+    data = Path(path).read_bytes()
+    if data[:8] != PNG_SIGNATURE:
+        raise ValueError(f"{path}: not a PNG")
+    pos, idat, header = 8, [], None
+    while pos < len(data):
+        length, ctype = struct.unpack('>I4s', data[pos:pos + 8])
+        body = data[pos + 8:pos + 8 + length]
+        if ctype == b'IHDR':
+            header = struct.unpack('>IIBBBBB', body)
+        elif ctype == b'IDAT':
+            idat.append(body)
+        elif ctype == b'IEND':
+            break
+        pos += 12 + length
+    if header is None:
+        raise ValueError(f"{path}: no IHDR")
+    w, h, depth, colour, _, _, interlace = header
+    if depth != 8 or colour not in PNG_CHANNELS or interlace:
+        raise ValueError(f"{path}: only 8-bit grey/RGB/RGBA non-interlaced PNGs are supported")
+
+    bpp = PNG_CHANNELS[colour]
+    stride = w * bpp
+    raw = zlib.decompress(b''.join(idat))
+    out = np.zeros((h, stride), dtype=np.uint8)
+    prev = np.zeros(stride, dtype=np.int32)
+    for y in range(h):
+        ftype = raw[y * (stride + 1)]
+        line = np.frombuffer(raw, dtype=np.uint8, count=stride,
+                             offset=y * (stride + 1) + 1).astype(np.int32)
+        if ftype == 0:
+            cur = line
+        elif ftype == 2:
+            cur = (line + prev) & 0xFF
+        elif ftype in (1, 3, 4):
+            # Depend on the reconstructed pixel to the left: per byte
+            cur = line.copy()
+            for i in range(stride):
+                a = cur[i - bpp] if i >= bpp else 0
+                if ftype == 1:
+                    cur[i] = (cur[i] + a) & 0xFF
+                elif ftype == 3:
+                    cur[i] = (cur[i] + ((a + prev[i]) >> 1)) & 0xFF
+                else:
+                    c = prev[i - bpp] if i >= bpp else 0
+                    cur[i] = (cur[i] + _paeth(a, prev[i], c)) & 0xFF
+        else:
+            raise ValueError(f"{path}: bad filter type {ftype}")
+        out[y] = cur
+        prev = cur
+
+    img = out.reshape(h, w, bpp)
+    if bpp == 1:
+        return np.repeat(img, 3, axis=2)
+    return img[:, :, :3]
+
+
+def write_png(path, img):
+    """Write an (h, w, 3) uint8 array as an unfiltered RGB PNG"""
+    h, w, _ = img.shape
+    raw = b''.join(b'\x00' + img[y].tobytes() for y in range(h))
+
+    def chunk(ctype, body):
+        crc = zlib.crc32(ctype + body)
+        return struct.pack('>I', len(body)) + ctype + body + struct.pack('>I', crc)
+
+    Path(path).write_bytes(PNG_SIGNATURE +
+                           chunk(b'IHDR', struct.pack('>IIBBBBB', w, h, 8, 2, 0, 0, 0)) +
+                           chunk(b'IDAT', zlib.compress(raw, 6)) +
+                           chunk(b'IEND', b''))
+
+
+def compare(actual, reference, tolerance):
+    """Return (differing pixel mask, max channel delta); None if sizes differ"""
+    if actual.shape != reference.shape:
+        return None
+    delta = np.abs(actual.astype(np.int16) - reference.astype(np.int16)).max(axis=2)
+    return delta > tolerance, int(delta.max())
+
+
+def diff_image(reference, mask):
+    out = reference // 3
+    out[mask] = (255, 0, 0)
+    return out
+
+
+def image_pairs(actual, reference):
+    """(name, actual path or None, reference path) for every reference image"""
+    actual, reference = Path(actual), Path(reference)
+    if not reference.is_dir():
+        return [(reference.name, actual if actual.exists() else None, reference)]
+    pairs = []
+    for ref in sorted(reference.glob('*.png')):
+        act = actual / ref.name
+        pairs.append((ref.name, act if act.exists() else None, ref))
+    return pairs
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Compare captured frames against references')
+    parser.add_argument('actual', help='Captured PNG or directory of frames')
+    parser.add_argument('reference', help='Reference PNG or directory')
+    parser.add_argument('--tolerance', type=int, default=0,
+                        help='Allowed per-channel difference (default: 0)')
+    parser.add_argument('--max-pixels', type=int, default=0,
+                        help='Allowed number of differing pixels per image (default: 0)')
+    parser.add_argument('--diff-dir', help='Write a diff image for each failing frame here')
+    args = parser.parse_args()
+
+    pairs = image_pairs(args.actual, args.reference)
+    if not pairs:
+        print(f"Error: no reference images in {args.reference}")
+        sys.exit(1)
+    if args.diff_dir:
+        Path(args.diff_dir).mkdir(parents=True, exist_ok=True)
+
+    failed = 0
+    for name, act, ref in pairs:
+        if act is None:
+            print(f"{name}: MISSING")
+            failed += 1
+            continue
+        reference = read_png(ref)
+        actual = read_png(act)
+        result = compare(actual, reference, args.tolerance)
+        if result is None:
+            print(f"{name}: FAIL size {actual.shape[1]}x{actual.shape[0]}, "
+                  f"expected {reference.shape[1]}x{reference.shape[0]}")
+            failed += 1
+            continue
+        mask, max_delta = result
+        count = int(mask.sum())
+        if count > args.max_pixels:
+            print(f"{name}: FAIL {count} pixels differ (max delta {max_delta})")
+            failed += 1
+            if args.diff_dir:
+                write_png(Path(args.diff_dir) / name, diff_image(reference, mask))
+        else:
+            print(f"{name}: ok" + (f" ({count} pixels within limit)" if count else ""))
+
+    print(f"{len(pairs) - failed}/{len(pairs)} images match")
+    sys.exit(1 if failed else 0)
+
+
+if __name__ == '__main__':
+    main()
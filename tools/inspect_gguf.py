@@ -0,0 +1,105 @@
+#!/usr/bin/env python3
+"""
+Inspect a GGUF model: header, metadata, tensor table and per-type totals.
+
+Only the header is parsed; tensor data is read lazily through mmap views,
+so listing a model is instant regardless of size. --stats dequantizes one
+tensor at a time.
+
+Usage:
+    python tools/inspect_gguf.py model.gguf
+    python tools/inspect_gguf.py --stats model.gguf
+    python tools/inspect_gguf.py -t blk.0.attn_q.weight model.gguf
+"""
+
+import argparse
+import sys
+import numpy as np
+
+import gguf
+
+# Array items shown before eliding
+MAX_ITEMS = 8
+
+
+def format_value(reader, key):
+    """Short printable form of a metadata value."""
+    vtype, arr_type = reader.value_type(key)
+    value = reader.get(key)
+    if vtype == gguf.GGUF_TYPE_STRING:
+        return repr(value.decode('utf-8', errors='replace'))
+    if vtype != gguf.GGUF_TYPE_ARRAY:
+        return str(value)
+
+    items = value[:MAX_ITEMS]
+    if arr_type == gguf.GGUF_TYPE_STRING:
+        shown = [repr(v.decode('utf-8', errors='replace')) for v in items]
+    else:
+        shown = [str(v) for v in items]
+    more = ', ...' if len(value) > MAX_ITEMS else ''
+    return f"[{len(value)}] [{', '.join(shown)}{more}]"
+
+
+def tensor_stats(reader, tensor):
+    """min/max/mean/rms of a tensor's dequantized values."""
+    values = reader.tensor_float(tensor)
+    return (float(values.min()), float(values.max()),
+            float(values.mean()), float(np.sqrt(np.mean(values.astype(np.float64) ** 2))))
+
+
+def inspect(path, stats=False, tensor_names=()):
+    reader = gguf.GGUFReader(path)
+
+    print(f"{path}: GGUF v{reader.version}, {len(reader.tensors)} tensors, "
+          f"{len(reader.keys)} metadata entries, alignment {reader.alignment}")
+    print(f"Data section at 0x{reader.data_start:X}")
+
+    print("\nMetadata:")
+    for key in reader.keys:
+        print(f"  {key} = {format_value(reader, key)}")
+
+    print("\nTensors:")
+    print(f"  {'name':<32} {'type':<7} {'shape':<16} {'offset':>10} {'size':>10}")
+    totals = {}
+    for t in reader.tensors:
+        shape = 'x'.join(str(d) for d in t.dims)
+        line = f"  {t.name:<32} {t.type_name:<7} {shape:<16} {t.offset:>10X} {t.nbytes:>10,}"
+        if stats and t.dtype in gguf.GGML_TYPE_LAYOUT:
+            lo, hi, mean, rms = tensor_stats(reader, t)
+            line += f"  min {lo:+.4f} max {hi:+.4f} mean {mean:+.5f} rms {rms:.4f}"
+        print(line)
+        count, size = totals.get(t.type_name, (0, 0))
+        totals[t.type_name] = (count + 1, size + t.nbytes)
+
+    print("\nTotals:")
+    for name, (count, size) in sorted(totals.items()):
+        print(f"  {name:<7} {count:4} tensors {size / 1024 / 1024:9.2f} MB")
+    total = sum(size for _, size in totals.values())
+    print(f"  {'all':<7} {len(reader.tensors):4} tensors {total / 1024 / 1024:9.2f} MB")
+
+    for name in tensor_names:
+        t = reader.tensor(name)
+        values = reader.tensor_float(t)
+        print(f"\n{name} ({t.type_name}, {'x'.join(str(d) for d in t.dims)}):")
+        print(f"  {values[:MAX_ITEMS]}")
+        lo, hi, mean, rms = tensor_stats(reader, t)
+        print(f"  min {lo:+.6f} max {hi:+.6f} mean {mean:+.6f} rms {rms:.6f}")
+
+
+if __name__ == '__main__':
+    parser = argparse.ArgumentParser(description='Inspect a GGUF model')
+    parser.add_argument('model', help='GGUF file')
+    parser.add_argument('--stats', action='store_true',
+                        help='Print value statistics for every tensor')
+    parser.add_argument('-t', '--tensor', action='append', default=[],
+                        help='Dump values of a tensor (repeatable)')
+    args = parser.parse_args()
+
+    try:
+        inspect(args.model, args.stats, args.tensor)
+    except ValueError as e:
+        print(f"Error: {e}")
+        sys.exit(1)
+    except KeyError as e:
+        print(f"Error: no tensor named {e}")
+        sys.exit(1)
@@ -0,0 +1,160 @@
+#!/usr/bin/env python3
+"""
+Host reference of the llama2.c forward pass over GGUF weights.
+
+Used to measure what a weight format costs in accuracy before it goes
+near the hardware. Weights are dequantized with gguf.dequantize, so a
+Q16.16 or Q4_Q16 model sees exactly the values the DMA accelerator
+multiplies by; the arithmetic itself is float32.
+
+Follows convert_to_gguf.py: [rows, cols] matrices, llama2.c RoPE (pairs
+of adjacent elements, no Q/K permutation) and the llama2.c tokenizer
+stored in tokenizer.ggml.tokens/scores.
+"""
+
+import numpy as np
+
+import gguf
+
+
+class Tokenizer:
+    """llama2.c BPE: greedy merges by score, byte fallback tokens."""
+
+    def __init__(self, reader):
+        tokens = reader.get('tokenizer.ggml.tokens')
+        scores = reader.get('tokenizer.ggml.scores')
+        if tokens is None or scores is None:
+            raise ValueError("GGUF has no tokenizer.ggml.tokens/scores")
+        self.tokens = list(tokens)
+        self.scores = np.asarray(scores, dtype=np.float32)
+        self.lookup = {t: i for i, t in enumerate(self.tokens)}
+        self.bos = int(reader.get('tokenizer.ggml.bos_token_id', 1))
+
+    def encode(self, text, bos=True):
+        ids = []
+        if text:
+            ids.append(self.lookup[b' '])  # Dummy prefix, as sentencepiece
+        for ch in text:
+            tok = self.lookup.get(ch.encode('utf-8'))
+            if tok is not None:
+                ids.append(tok)
+            else:
+                # Byte fallback: <0x00>.. follow the 3 special tokens
+                ids.extend(b + 3 for b in ch.encode('utf-8'))
+
+        while True:
+            best, best_score = None, -1e10
+            for i in range(len(ids) - 1):
+                tok = self.lookup.get(self.tokens[ids[i]] + self.tokens[ids[i + 1]])
+                if tok is not None and self.scores[tok] > best_score:
+                    best, best_score = (i, tok), self.scores[tok]
+            if best is None:
+                break
+            i, tok = best
+            ids[i:i + 2] = [tok]
+
+        return [self.bos] + ids if bos else ids
+
+    def decode(self, ids):
+        pieces = []
+        for i in ids:
+            tok = self.tokens[i]
+            if len(tok) == 6 and tok.startswith(b'<0x') and tok.endswith(b'>'):
+                tok = bytes([int(tok[3:5], 16)])
+            pieces.append(tok)
+        return b''.join(pieces).decode('utf-8', errors='replace')
+
+
+class Model:
+    """Weights dequantized to float32 once; forward() runs one token."""
+
+    def __init__(self, path, seq_len=None):
+        self.reader = gguf.GGUFReader(path)
+        r = self.reader
+
+        def key(name):
+            value = r.get(f'llama.{name}')
+            if value is None:
+                raise ValueError(f"Missing metadata llama.{name}")
+            return int(value)
+
+        self.dim = key('embedding_length')
+        self.n_layers = key('block_count')
+        self.n_heads = key('attention.head_count')
+        self.n_kv_heads = int(r.get('llama.attention.head_count_kv', self.n_heads))
+        self.seq_len = seq_len or key('context_length')
+        self.head_size = self.dim // self.n_heads
+        self.kv_dim = self.head_size * self.n_kv_heads
+
+        self.token_embd = self.weight('token_embd.weight')
+        self.layers = []
+        for l in range(self.n_layers):
+            self.layers.append({name: self.weight(f'blk.{l}.{name}.weight') for name in (
+                'attn_norm', 'attn_q', 'attn_k', 'attn_v', 'attn_output',
+                'ffn_norm', 'ffn_gate', 'ffn_down', 'ffn_up')})
+        self.output_norm = self.weight('output_norm.weight')
+        names = {t.name for t in r.tensors}
+        self.output = self.weight('output.weight') if 'output.weight' in names else self.token_embd
+
+        freqs = 1.0 / 10000.0 ** (np.arange(0, self.head_size, 2) / self.head_size)
+        angles = np.outer(np.arange(self.seq_len), freqs)
+        self.rope_cos = np.cos(angles).astype(np.float32)
+        self.rope_sin = np.sin(angles).astype(np.float32)
+        self.reset()
+
+    def weight(self, name):
+        t = self.reader.tensor(name)
+        w = self.reader.tensor_float(t)
+        return w.reshape(t.dims) if len(t.dims) > 1 else w
+
+    def matmul(self, w, x):
+        """Matrix-vector product; overridden to model other arithmetic."""
+        return w @ x
+
+    def embed(self, token):
+        return self.token_embd[token].astype(np.float32)
+
+    def reset(self):
+        self.key_cache = np.zeros((self.n_layers, self.seq_len, self.kv_dim), dtype=np.float32)
+        self.value_cache = np.zeros_like(self.key_cache)
+
+    @staticmethod
+    def rmsnorm(x, w):
+        return w * (x / np.sqrt(np.mean(x * x) + 1e-5))
+
+    def rope(self, v, pos):
+        pairs = v.reshape(-1, self.head_size // 2, 2)
+        cos, sin = self.rope_cos[pos], self.rope_sin[pos]
+        v0, v1 = pairs[..., 0], pairs[..., 1]
+        return np.stack([v0 * cos - v1 * sin, v0 * sin + v1 * cos], axis=-1).reshape(-1)
+
+    def forward(self, token, pos):
+        """Logits for token at position pos (fills the KV cache)."""
+        x = self.embed(token)
+        kv_mul = self.n_heads // self.n_kv_heads
+
+        for l, w in enumerate(self.layers):
+            xb = self.rmsnorm(x, w['attn_norm'])
+            q = self.rope(self.matmul(w['attn_q'], xb), pos)
+            self.key_cache[l, pos] = self.rope(self.matmul(w['attn_k'], xb), pos)
+            self.value_cache[l, pos] = self.matmul(w['attn_v'], xb)
+
+            q = q.reshape(self.n_heads, self.head_size)
+            k = self.key_cache[l, :pos + 1].reshape(pos + 1, self.n_kv_heads, self.head_size)
+            v = self.value_cache[l, :pos + 1].reshape(pos + 1, self.n_kv_heads, self.head_size)
+            k = np.repeat(k, kv_mul, axis=1)
+            v = np.repeat(v, kv_mul, axis=1)
+            att = np.einsum('hd,thd->ht', q, k) / np.sqrt(self.head_size)
+            att = np.exp(att - att.max(axis=1, keepdims=True))
+            att /= att.sum(axis=1, keepdims=True)
+            xb = np.einsum('ht,thd->hd', att, v).reshape(-1)
+            x = x + self.matmul(w['attn_output'], xb)
+
+            xb = self.rmsnorm(x, w['ffn_norm'])
+            h1 = self.matmul(w['ffn_gate'], xb)
+            h3 = self.matmul(w['ffn_up'], xb)
+            hb = h1 / (1.0 + np.exp(-h1)) * h3  # SwiGLU
+            x = x + self.matmul(w['ffn_down'], hb)
+
+        x = self.rmsnorm(x, self.output_norm)
+        return self.matmul(self.output, x)
@@ -0,0 +1,150 @@
+#!/usr/bin/env python3
+"""
+Check firmware benchmark cycle counts against a checked-in baseline.
+
+Runs the perf firmware variant (perf.c) through the firmware runner
+(FW_RUN, normally the Verilator SoC harness), collects the
+"perf: <name> <cycles>" lines it prints from the perf_results block, and
+compares each benchmark against the baseline JSON:
+
+    {
+      "threshold_pct": 2.0,
+      "benchmarks": {
+        "dashboard": {"cycles": 1234567},
+        "matvec": {"cycles": 89012, "threshold_pct": 5.0},
+        ...
+      }
+    }
+
+A benchmark fails when it is more than its threshold (or the file-wide
+default) slower than the baseline, or when it is missing from the run.
+A benchmark without a recorded baseline ("cycles": null) is reported, with
+a warning to record one; it only fails with --require-baseline (for CI
+once the baseline exists). --update writes the measured counts into the
+baseline, keeping the thresholds.
+
+Usage:
+    python tools/perf_check.py --runner src/fpga/sim/obj_soc/Vsim_soc \\
+        --baseline src/firmware/perf_baseline.json src/firmware/build/perf/firmware.elf
+"""
+
+import argparse
+import json
+import os
+import re
+import subprocess
+import sys
+from pathlib import Path
+
+DEFAULT_THRESHOLD_PCT = 2.0
+
+PERF_LINE = re.compile(r'^perf: (\S+) (\d+)$')
+
+
+def run_benchmarks(runner, elf):
+    """Run the ELF and return {name: cycles} from its perf lines"""
+    result = subprocess.run(runner.split() + [str(elf)], capture_output=True, text=True)
+    if result.returncode != 0:
+        sys.stderr.write(result.stdout + result.stderr)
+        raise ValueError(f"runner failed with exit code {result.returncode}")
+    results = {}
+    for line in result.stdout.splitlines():
+        m = PERF_LINE.match(line.strip())
+        if m:
+            results[m.group(1)] = int(m.group(2))
+    if not results:
+        raise ValueError("runner printed no perf results (is this the perf variant?)")
+    return results
+
+
+def compare(results, baseline, require_baseline=False):
+    """Print the comparison table; return (failures, benchmarks without a baseline)"""
+    default_pct = baseline.get('threshold_pct', DEFAULT_THRESHOLD_PCT)
+    benchmarks = baseline.get('benchmarks', {})
+    failures = 0
+    unrecorded = 0
+
+    print(f"{'benchmark':<12} {'baseline':>10} {'cycles':>10} {'change':>8}  result")
+    for name in sorted(set(benchmarks) | set(results)):
+        entry = benchmarks.get(name, {})
+        base = entry.get('cycles')
+        limit = entry.get('threshold_pct', default_pct)
+        cycles = results.get(name)
+
+        if cycles is None:
+            status, change = "MISSING", ""
+            failures += 1
+        elif name not in benchmarks:
+            status, change = "new (not in baseline)", ""
+        elif base is None:
+            unrecorded += 1
+            if require_baseline:
+                status, change = "FAIL (no baseline)", ""
+                failures += 1
+            else:
+                status, change = "no baseline", ""
+        else:
+            pct = (cycles - base) * 100.0 / base
+            change = f"{pct:+.1f}%"
+            if pct > limit:
+                status = f"FAIL (limit +{limit:g}%)"
+                failures += 1
+            elif pct < -limit:
+                status = "faster - update the baseline"
+            else:
+                status = "ok"
+
+        print(f"{name:<12} {base if base is not None else '-':>10} "
+              f"{cycles if cycles is not None else '-':>10} {change:>8}  {status}")
+    return failures, unrecorded
+
+
+def update_baseline(path, baseline, results):
+    benchmarks = baseline.setdefault('benchmarks', {})
+    for name, cycles in results.items():
+        benchmarks.setdefault(name, {})['cycles'] = cycles
+    baseline.setdefault('threshold_pct', DEFAULT_THRESHOLD_PCT)
+    Path(path).write_text(json.dumps(baseline, indent=2) + '\n')
+    print(f"Updated {path}")
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Compare benchmark cycle counts with a baseline')
+    parser.add_argument('elf', help='perf variant firmware ELF')
+    parser.add_argument('--baseline', required=True, help='Baseline JSON')
+    parser.add_argument('--runner', default=os.environ.get('FW_RUN'),
+                        help='Firmware runner (default: $FW_RUN)')
+    parser.add_argument('--update', action='store_true',
+                        help='Record the measured cycles as the new baseline')
+    parser.add_argument('--require-baseline', action='store_true',
+                        help='Fail benchmarks whose baseline cycles are null')
+    args = parser.parse_args()
+
+    if not args.runner:
+        print("Error: no runner - pass --runner or set FW_RUN (make -C src/fpga/sim soc)")
+        sys.exit(1)
+
+    baseline = {}
+    if Path(args.baseline).exists():
+        baseline = json.loads(Path(args.baseline).read_text())
+
+    try:
+        results = run_benchmarks(args.runner, args.elf)
+    except ValueError as e:
+        print(f"Error: {e}")
+        sys.exit(1)
+
+    failures, unrecorded = compare(results, baseline, args.require_baseline)
+    if args.update:
+        update_baseline(args.baseline, baseline, results)
+        return
+    if unrecorded and not args.require_baseline:
+        print(f"Warning: {unrecorded} benchmark(s) have no baseline and were not checked "
+              f"- record one with make perf-baseline")
+    if failures:
+        print(f"{failures} benchmark(s) regressed, missing or without a baseline")
+        sys.exit(1)
+
+
+if __name__ == '__main__':
+    main()
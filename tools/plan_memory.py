@@ -0,0 +1,387 @@
+#!/usr/bin/env python3
+"""
+Plan where model data lives across BRAM, SDRAM and PSRAM.
+
+Reads a GGUF (for the model config and tensor list) and places every
+buffer a llama2.c-style forward pass needs:
+
+  - the weight image from export_layout.py (SDRAM only - the DMA
+    accelerator can only reach SDRAM)
+  - the key/value caches
+  - activation buffers (x, xb, q, hb, att, logits, ...)
+  - small weight vectors (norms), optionally copied out of the image
+  - the SDRAM/PSRAM memtest regions
+
+alongside the fixed regions the hardware and linker.ld already own
+(framebuffers, firmware SDRAM image, PSRAM scratch).
+
+Each buffer gets an estimated access density (bytes touched per token /
+bytes stored). Buffers are placed densest first into the cheapest region
+they are allowed in that still has room. In SDRAM the weight image is
+allocated bottom-up and everything else top-down. The bank column shows
+which SDRAM banks an object touches under io_sdram's bank-XOR address
+map (ADDR_MAP_XOR, as core_top builds it), which rotates the bank every
+2KB row, so anything over a few rows spans all four.
+
+Outputs:
+  --header    C header with MAP_<NAME>_ADDR / MAP_<NAME>_SIZE
+  --ld        linker fragment (BRAM scratch size, absolute symbols)
+  --manifest  JSON loader manifest (objects, data slots, copies)
+  --data-json update the model slot of an APF data.json in place
+
+Usage:
+    python tools/plan_memory.py --header src/firmware/model_map.h \\
+        --ld src/firmware/model_map.ld --manifest model_manifest.json \\
+        --data-json data.json model_q16.gguf
+"""
+
+import argparse
+import json
+import re
+import sys
+from pathlib import Path
+
+import gguf
+import export_layout
+
+# CPU address of each region and its size
+BRAM_BASE = 0x00000000
+SDRAM_BASE = 0x10000000
+SDRAM_BYTES = 64 * 1024 * 1024
+SDRAM_ROW_BYTES = 2048                 # 1024 16-bit columns
+PSRAM_BASE = 0x30000000
+PSRAM_BYTES = 16 * 1024 * 1024
+
+# Relative cost of a 32-bit access, used only for the plan summary
+REGION_COST = {'bram': 1, 'sdram': 4, 'psram': 10}
+REGION_ORDER = ('bram', 'sdram', 'psram')
+
+# Regions owned by hardware and linker.ld: (name, region, offset, size)
+FIXED_OBJECTS = [
+    ('framebuffer0', 'sdram', 0x00000000, 0x00100000),
+    ('framebuffer1', 'sdram', 0x00100000, 0x00100000),
+    ('firmware_sdram', 'sdram', 0x00300000, 0x00500000),
+    ('firmware_scratch', 'psram', 0x00100000, 0x00100000),
+]
+
+MODEL_SLOT_ID = 2
+MODEL_SLOT_NAME = "Model weights"
+
+
+class Region:
+    """Simple allocator: a sorted list of free [start, end) ranges."""
+
+    def __init__(self, name, size):
+        self.name = name
+        self.size = size
+        self.free = [(0, size)]
+
+    def reserve(self, start, size):
+        end = start + size
+        for i, (a, b) in enumerate(self.free):
+            if a <= start and end <= b:
+                self.free[i:i + 1] = [r for r in ((a, start), (end, b)) if r[0] < r[1]]
+                return start
+        raise ValueError(f"{self.name}: 0x{start:X}+0x{size:X} overlaps another object")
+
+    def alloc(self, size, alignment, top_down=False):
+        ranges = reversed(self.free) if top_down else self.free
+        for a, b in ranges:
+            start = (b - size) // alignment * alignment if top_down else gguf.align(a, alignment)
+            if a <= start and start + size <= b:
+                return self.reserve(start, size)
+        return None
+
+
+def model_config(reader, seq_len=None):
+    """Model dimensions from the GGUF llama.* metadata."""
+    def key(name):
+        value = reader.get(f'llama.{name}')
+        if value is None:
+            raise ValueError(f"Missing metadata llama.{name}")
+        return int(value)
+
+    dim = key('embedding_length')
+    n_heads = key('attention.head_count')
+    tokens = reader.get('tokenizer.ggml.tokens')
+    config = {
+        'dim': dim,
+        'hidden_dim': key('feed_forward_length'),
+        'n_layers': key('block_count'),
+        'n_heads': n_heads,
+        'n_kv_heads': int(reader.get('llama.attention.head_count_kv', n_heads)),
+        'seq_len': seq_len or key('context_length'),
+        'vocab_size': len(tokens) if tokens is not None else reader.tensors[0].dims[0],
+    }
+    config['kv_dim'] = dim // n_heads * config['n_kv_heads']
+    return config
+
+
+def plan_objects(reader, config, layout_entries, image_bytes):
+    """Buffers to place: (name, size, density, allowed regions, alignment)."""
+    c = config
+    L = c['n_layers']
+    # Attention reads on average half the context per token
+    avg_pos = c['seq_len'] / 2
+    objects = []
+
+    def add(name, size, density, regions, alignment=4, **extra):
+        objects.append(dict(name=name, size=size, density=density, regions=regions,
+                            alignment=alignment, **extra))
+
+    # Weights stream through the DMA once per token
+    add('weights', image_bytes, 1.0, ('sdram',), export_layout.WL_PAGE_BYTES,
+        slot=True)
+
+    # Key/value caches: one kv_dim row per layer written, avg_pos rows read
+    kv_bytes = L * c['seq_len'] * c['kv_dim'] * 4
+    add('key_cache', kv_bytes, avg_pos / c['seq_len'], ('sdram', 'psram'),
+        export_layout.WL_PAGE_BYTES)
+    add('value_cache', kv_bytes, avg_pos / c['seq_len'], ('sdram', 'psram'),
+        export_layout.WL_PAGE_BYTES)
+
+    # Activations: element accesses per layer per token (llama2.c forward)
+    cpu = ('bram', 'sdram', 'psram')
+    add('x', c['dim'] * 4, 8 * L, cpu)
+    add('xb', c['dim'] * 4, 8 * L, cpu)
+    add('xb2', c['dim'] * 4, 3 * L, cpu)
+    add('q', c['dim'] * 4, (3 + avg_pos / c['n_heads']) * L, cpu)
+    add('hb', c['hidden_dim'] * 4, 5 * L, cpu)
+    add('hb2', c['hidden_dim'] * 4, 3 * L, cpu)
+    add('att', c['n_heads'] * c['seq_len'] * 4, 4 * L * avg_pos / c['seq_len'], cpu)
+    add('logits', c['vocab_size'] * 4, 3, cpu)
+
+    # Norm vectors are read by the CPU once per token; copy them out of the
+    # image if there is room left in a faster region
+    for e in layout_entries:
+        if e['rows'] == 1:
+            add('copy:' + e['name'], e['cols'] * 4, 1.0, ('bram',),
+                source_offset=e['offset'])
+
+    add('sdram_memtest', 0x00100000, 0.0, ('sdram',), 0x00100000)
+    add('psram_memtest', 0x00100000, 0.0, ('psram',), 0x00100000)
+    return objects
+
+
+def solve(objects, bram_budget):
+    regions = {
+        'bram': Region('bram', bram_budget),
+        'sdram': Region('sdram', SDRAM_BYTES),
+        'psram': Region('psram', PSRAM_BYTES),
+    }
+    placed = []
+    for name, region, offset, size in FIXED_OBJECTS:
+        regions[region].reserve(offset, size)
+        placed.append(dict(name=name, region=region, offset=offset, size=size,
+                           density=0.0, fixed=True))
+
+    # Memtest regions first so they keep their historical low addresses,
+    # then densest first
+    order = sorted(objects, key=lambda o: (not o['name'].endswith('memtest'), -o['density'], o['size']))
+    for obj in order:
+        for region in REGION_ORDER:
+            if region not in obj['regions']:
+                continue
+            top_down = region == 'sdram' and obj['name'] not in ('weights', 'sdram_memtest')
+            offset = regions[region].alloc(obj['size'], obj['alignment'], top_down)
+            if offset is not None:
+                placed.append(dict(obj, region=region, offset=offset))
+                break
+        else:
+            if obj['name'].startswith('copy:'):
+                continue  # Optional: stays in the weight image
+            raise ValueError(f"No room for {obj['name']} ({obj['size']:,} bytes)")
+
+    bram_used = max((o['offset'] + o['size'] for o in placed if o['region'] == 'bram'), default=0)
+    return placed, gguf.align(bram_used, 4)
+
+
+def cpu_address(obj):
+    return {'sdram': SDRAM_BASE, 'psram': PSRAM_BASE, 'bram': BRAM_BASE}[obj['region']] + obj['offset']
+
+
+def sdram_bank(offset):
+    """Bank of an SDRAM byte offset under ADDR_MAP_XOR (map_bank in io_sdram.v):
+    word address bits [11:10] XORed with each 2-bit group of the row, [24:12]"""
+    word = offset >> 1
+    bank = (word >> 10) & 3
+    row = word >> 12
+    while row:
+        bank ^= row & 3
+        row >>= 2
+    return bank
+
+
+def banks(obj):
+    if obj['region'] != 'sdram':
+        return ''
+    first = obj['offset'] // SDRAM_ROW_BYTES
+    last = (obj['offset'] + obj['size'] - 1) // SDRAM_ROW_BYTES
+    found = set()
+    for row in range(first, last + 1):
+        found.add(sdram_bank(row * SDRAM_ROW_BYTES))
+        if len(found) == 4:
+            return 'all'
+    return ','.join(str(b) for b in sorted(found))
+
+
+def c_name(name):
+    return 'MAP_' + re.sub(r'[^A-Za-z0-9]', '_', name.replace('copy:', '')).upper()
+
+
+def write_header(path, source, placed, bram_size):
+    lines = [
+        f"/* Generated by tools/plan_memory.py from {Path(source).name} - do not edit */",
+        "",
+        "#ifndef MODEL_MAP_H",
+        "#define MODEL_MAP_H",
+        "",
+        "#include <stdint.h>",
+        "",
+        "/* BRAM scratch reserved by linker.ld from model_map.ld */",
+        "extern uint8_t __model_bram_start[];",
+        f"#define MAP_BRAM_SIZE {bram_size}",
+        "",
+    ]
+    for o in sorted(placed, key=cpu_address):
+        if o['name'].startswith('copy:'):
+            continue
+        lines.append(f"/* {o['name']}: {o['region']}, {o['size']:,} bytes */")
+        if o['region'] == 'bram':
+            lines.append(f"#define {c_name(o['name'])}_ADDR ((uint32_t)__model_bram_start + 0x{o['offset']:X})")
+        else:
+            lines.append(f"#define {c_name(o['name'])}_ADDR 0x{cpu_address(o):08X}")
+        lines.append(f"#define {c_name(o['name'])}_SIZE {o['size']}")
+    weights = next(o for o in placed if o['name'] == 'weights')
+    lines += [
+        "",
+        "/* Image offset in SDRAM, for wl_row_addr() */",
+        f"#define MAP_WEIGHTS_SDRAM_OFFSET 0x{weights['offset']:08X}",
+        "",
+        "/* Weight vectors copied from the image into BRAM at load: {image offset, BRAM offset, bytes} */",
+    ]
+    copies = [o for o in placed if o['name'].startswith('copy:')]
+    lines.append(f"#define MAP_N_COPIES {len(copies)}")
+    lines.append("#define MAP_COPIES { \\")
+    for o in copies:
+        lines.append(f"    {{0x{o['source_offset']:X}, 0x{o['offset']:X}, {o['size']}}}, /* {o['name'][5:]} */ \\")
+    lines += ["}", "", "#endif /* MODEL_MAP_H */", ""]
+    Path(path).write_text('\n'.join(lines))
+
+
+def write_ld(path, source, placed, bram_size):
+    lines = [
+        f"/* Generated by tools/plan_memory.py from {Path(source).name} - do not edit */",
+        "/* Linked in by src/firmware/Makefile when present */",
+        "",
+        f"__model_bram_size = 0x{bram_size:X};",
+    ]
+    for o in placed:
+        if o['region'] != 'bram' and not o['name'].startswith('copy:'):
+            lines.append(f"PROVIDE(__map_{c_name(o['name'])[4:].lower()} = 0x{cpu_address(o):08X});")
+    Path(path).write_text('\n'.join(lines) + '\n')
+
+
+def data_slot(placed, filename):
+    weights = next(o for o in placed if o['name'] == 'weights')
+    return {
+        'name': MODEL_SLOT_NAME,
+        'id': MODEL_SLOT_ID,
+        'required': False,
+        'parameters': '0x00',
+        'filename': filename,
+        'address': f"0x{weights['offset']:08X}",
+    }
+
+
+def write_manifest(path, source, config, placed, bram_size, slot):
+    objects = []
+    for o in sorted(placed, key=cpu_address):
+        if o['name'].startswith('copy:'):
+            continue
+        objects.append({
+            'name': o['name'],
+            'region': o['region'],
+            'address': f"0x{cpu_address(o):08X}" if o['region'] != 'bram' else f"bram+0x{o['offset']:X}",
+            'size': o['size'],
+            'sdram_bank': banks(o),
+            'density': round(o['density'], 3),
+            'fixed': o.get('fixed', False),
+        })
+    manifest = {
+        'model': Path(source).name,
+        'config': config,
+        'bram_scratch': bram_size,
+        'objects': objects,
+        'data_slots': [slot],
+        'copies': [{'tensor': o['name'][5:], 'image_offset': o['source_offset'],
+                    'bram_offset': o['offset'], 'size': o['size']}
+                   for o in placed if o['name'].startswith('copy:')],
+    }
+    Path(path).write_text(json.dumps(manifest, indent=4) + '\n')
+
+
+def update_data_json(path, slot):
+    data = json.loads(Path(path).read_text())
+    slots = [s for s in data['data']['data_slots'] if s['id'] != slot['id']]
+    slots.append(slot)
+    data['data']['data_slots'] = sorted(slots, key=lambda s: s['id'])
+    Path(path).write_text(json.dumps(data, indent=4) + '\n')
+
+
+def plan_memory(model_path, args):
+    reader = gguf.GGUFReader(model_path)
+    config = model_config(reader, args.seq_len)
+    entries, image_bytes = export_layout.plan_layout(reader, args.row_align, args.tile)
+    objects = plan_objects(reader, config, entries, image_bytes)
+    placed, bram_size = solve(objects, args.bram)
+
+    print(f"Model: {config}")
+    print(f"  {'object':<32} {'region':<6} {'address':>10} {'size':>11} {'bank':>5} {'density':>8}")
+    total_cost = 0.0
+    for o in sorted(placed, key=lambda o: (REGION_ORDER.index(o['region']), o['offset'])):
+        addr = f"+0x{o['offset']:X}" if o['region'] == 'bram' else f"0x{cpu_address(o):08X}"
+        print(f"  {o['name']:<32} {o['region']:<6} {addr:>10} {o['size']:>11,} {banks(o):>5} {o['density']:>8.2f}")
+        total_cost += o['density'] * o['size'] / 4 * REGION_COST[o['region']]
+    print(f"BRAM scratch: {bram_size:,} of {args.bram:,} bytes")
+    print(f"Estimated memory cost: {total_cost / 1e6:.2f}M access-units per token")
+
+    slot = data_slot(placed, args.weights_file)
+    if args.header:
+        write_header(args.header, model_path, placed, bram_size)
+        print(f"Wrote {args.header}")
+    if args.ld:
+        write_ld(args.ld, model_path, placed, bram_size)
+        print(f"Wrote {args.ld}")
+    if args.manifest:
+        write_manifest(args.manifest, model_path, config, placed, bram_size, slot)
+        print(f"Wrote {args.manifest}")
+    if args.data_json:
+        update_data_json(args.data_json, slot)
+        print(f"Updated {args.data_json} slot {slot['id']} -> {slot['address']}")
+
+
+if __name__ == '__main__':
+    parser = argparse.ArgumentParser(description='Plan model memory placement')
+    parser.add_argument('model', help='GGUF model (as passed to export_layout.py)')
+    parser.add_argument('--bram', type=lambda s: int(s, 0), default=8192,
+                        help='BRAM scratch budget in bytes (default: 8192)')
+    parser.add_argument('--seq-len', type=int, default=None,
+                        help='Context length to size the KV cache for (default: from model)')
+    parser.add_argument('--row-align', choices=('pow2', 'page'), default='pow2',
+                        help='Weight row alignment, as for export_layout.py')
+    parser.add_argument('--tile', action='append', default=[], metavar='GLOB',
+                        help='Tiled matrices, as for export_layout.py')
+    parser.add_argument('--weights-file', default='model_layout.bin',
+                        help='Weight image filename for the data slot')
+    parser.add_argument('--header', help='Write C header')
+    parser.add_argument('--ld', help='Write linker fragment')
+    parser.add_argument('--manifest', help='Write JSON loader manifest')
+    parser.add_argument('--data-json', help='Update the model data slot in this data.json')
+    args = parser.parse_args()
+
+    try:
+        plan_memory(args.model, args)
+    except ValueError as e:
+        print(f"Error: {e}")
+        sys.exit(1)